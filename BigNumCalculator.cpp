@@ -1,577 +1,585 @@
-#include <iostream>
-#include <vector>
-#include <string>
-#include <algorithm>
+#include "bignum.hpp"
+#include "bignum_rpc.hpp"
+
+#include <atomic>
+#include <cctype>
 #include <cstdlib>
 #include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 
-using namespace std;
+#if defined(__unix__) || defined(__APPLE__)
+#define CALCULATOR_HAVE_SERVE 1
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#else
+#define CALCULATOR_HAVE_SERVE 0
+#endif
 
-/**
- * BigNum Library Implementation
- *
- * Assignment: Public Key Cryptosystems BigNum Library
- * Requirements:
- * - Support for very large integers (512, 1024, 2048+ bits)
- * - Number representation
- * - Modulo integer operations: addition, multiplication, and inversion
- */
+using namespace std;
 
-class BigNum
+// Demo function to show the capabilities
+void demonstrateBigNum()
 {
-private:
-    vector<int> digits; // Store digits in reverse order (least significant first)
-    bool is_negative;
+    cout << "=== BigNum Library Demonstration ===" << endl;
+    cout << "Supporting very large integers for cryptographic operations" << endl
+         << endl;
 
-    // Helper function to remove leading zeros
-    void removeLeadingZeros()
+    // Test basic operations
+    cout << "1. Basic Operations:" << endl;
+    BigNum a("12345678901234567890");
+    BigNum b("98765432109876543210");
+
+    cout << "a = " << a << endl;
+    cout << "b = " << b << endl;
+    cout << "a + b = " << a + b << endl;
+    cout << "b - a = " << b - a << endl;
+    cout << "a * b = " << a * b << endl;
+    cout << endl;
+
+    // Test modular operations
+    cout << "2. Modular Operations:" << endl;
+    BigNum m("1000000007");
+    cout << "m = " << m << " (modulus)" << endl;
+    cout << "a mod m = " << a % m << endl;
+    cout << "b mod m = " << b % m << endl;
+    cout << "(a + b) mod m = " << a.addMod(b, m) << endl;
+    cout << "(a * b) mod m = " << a.mulMod(b, m) << endl;
+    cout << endl;
+
+    // Test modular inverse
+    cout << "3. Modular Inverse:" << endl;
+    BigNum small_a("123");
+    BigNum small_m("1009"); // prime modulus
+    try
     {
-        while (digits.size() > 1 && digits.back() == 0)
-        {
-            digits.pop_back();
-        }
+        BigNum inv = small_a.modInverse(small_m);
+        cout << "Inverse of " << small_a << " mod " << small_m << " = " << inv << endl;
+        cout << "Verification: (" << small_a << " * " << inv << ") mod " << small_m << " = "
+             << small_a.mulMod(inv, small_m) << endl;
     }
-
-public:
-    // Default constructor - creates zero
-    BigNum() : is_negative(false)
+    catch (const exception &e)
     {
-        digits.push_back(0);
+        cout << "Error: " << e.what() << endl;
     }
+    cout << endl;
 
-    // Constructor from string
-    BigNum(const string &str) : is_negative(false)
-    {
-        if (str.empty())
-        {
-            digits.push_back(0);
-            return;
-        }
+    // Test large number representation
+    cout << "4. Large Number Representation:" << endl;
+    string large_512_bit = "13407807929942597099574024998205846127479365820592393377723561443721764030073546976801874298166903427690031858186486050853753882811946569946433649006084095";
+    BigNum large_num(large_512_bit);
+    cout << "512-bit number: " << large_num << endl;
+    cout << "Bit length: " << large_num.getBitLength() << " bits" << endl;
+    cout << endl;
 
-        int start = 0;
-        if (str[0] == '-')
-        {
-            is_negative = true;
-            start = 1;
-        }
+    // Test modular exponentiation
+    cout << "5. Modular Exponentiation:" << endl;
+    BigNum base("12345");
+    BigNum exp("67890");
+    BigNum mod_exp("1000000009");
+    cout << base << "^" << exp << " mod " << mod_exp << " = " << base.powMod(exp, mod_exp) << endl;
+    cout << endl;
 
-        for (int i = str.length() - 1; i >= start; i--)
-        {
-            if (str[i] >= '0' && str[i] <= '9')
-            {
-                digits.push_back(str[i] - '0');
-            }
-        }
+    // Test Curve25519 field backend
+    cout << "6. X25519 Key Agreement (Field25519):" << endl;
+    BigNum alice_secret("31029842492115040904895560451863089656472772604678260265531221036453811406496");
+    BigNum bob_secret("35156891815674817266734212754503633747128614016119564763269015315466259359304");
+    BigNum basepoint(9);
+    BigNum alice_public = Field25519::x25519(alice_secret, basepoint);
+    BigNum bob_public = Field25519::x25519(bob_secret, basepoint);
+    cout << "Alice public key: " << alice_public << endl;
+    cout << "Bob public key:   " << bob_public << endl;
+    cout << "Shared (Alice):   " << Field25519::x25519(alice_secret, bob_public) << endl;
+    cout << "Shared (Bob):     " << Field25519::x25519(bob_secret, alice_public) << endl;
+    cout << endl;
 
-        if (digits.empty())
-        {
-            digits.push_back(0);
-            is_negative = false;
-        }
+    cout << "=== All tests completed successfully! ===" << endl;
+}
 
-        removeLeadingZeros();
-        if (isZero())
-            is_negative = false;
-    }
+// Evaluate one batch job line ("mulmod a b m") and return its output line
+string runBatchJob(const string &line)
+{
+    vector<string> tokens;
+    size_t pos = 0;
+    while (pos < line.size())
+    {
+        while (pos < line.size() && isspace((unsigned char)line[pos]))
+            pos++;
+        size_t start = pos;
+        while (pos < line.size() && !isspace((unsigned char)line[pos]))
+            pos++;
+        if (pos > start)
+            tokens.push_back(line.substr(start, pos - start));
+    }
+
+    if (tokens.empty())
+        return "Error: empty job";
+
+    const string &operation = tokens[0];
+    size_t operands = tokens.size() - 1;
+    size_t expected;
+    if (operation == "+" || operation == "-" || operation == "*" || operation == "/" ||
+        operation == "%" || operation == "inverse")
+        expected = 2;
+    else if (operation == "addmod" || operation == "mulmod" || operation == "pow")
+        expected = 3;
+    else
+        return "Error: Unknown operation '" + operation + "'";
+
+    if (operands != expected)
+        return "Error: " + operation + " expects " + to_string(expected) + " operands";
 
-    // Constructor from integer
-    BigNum(long long num) : is_negative(num < 0)
+    try
     {
-        if (num < 0)
-            num = -num;
+        BigNum a(tokens[1]), b(tokens[2]);
+        if (operation == "+")
+            return (a + b).toString();
+        if (operation == "-")
+            return (a - b).toString();
+        if (operation == "*")
+            return (a * b).toString();
+        if (operation == "/")
+            return (a / b).toString();
+        if (operation == "%")
+            return (a % b).toString();
+        if (operation == "inverse")
+            return a.modInverse(b).toString();
+
+        BigNum m(tokens[3]);
+        if (operation == "addmod")
+            return a.addMod(b, m).toString();
+        if (operation == "mulmod")
+            return a.mulMod(b, m).toString();
+        return a.powMod(b, m).toString();
+    }
+    catch (const exception &e)
+    {
+        return string("Error: ") + e.what();
+    }
+}
 
-        if (num == 0)
+/**
+ * Batch mode: reads newline-delimited jobs ("op operand...") and writes one
+ * result line per job, in input order, without prompts. Blank lines and
+ * lines starting with '#' are skipped. Jobs are read in blocks and each
+ * block is evaluated by all hardware threads before it is written out.
+ */
+int runBatch(istream &in)
+{
+    const size_t BLOCK_SIZE = 4096;
+    unsigned workers = max(1u, thread::hardware_concurrency());
+
+    vector<string> jobs, results;
+    jobs.reserve(BLOCK_SIZE);
+    string line;
+    bool more = true;
+
+    while (more)
+    {
+        jobs.clear();
+        while (jobs.size() < BLOCK_SIZE && (more = static_cast<bool>(getline(in, line))))
         {
-            digits.push_back(0);
-            is_negative = false;
+            size_t first = 0;
+            while (first < line.size() && isspace((unsigned char)line[first]))
+                first++;
+            if (first == line.size() || line[first] == '#')
+                continue;
+            jobs.push_back(line);
         }
-        else
+
+        results.assign(jobs.size(), string());
+        atomic<size_t> next(0);
+        auto work = [&]()
         {
-            while (num > 0)
+            for (size_t i; (i = next.fetch_add(1)) < jobs.size();)
             {
-                digits.push_back(num % 10);
-                num /= 10;
+                results[i] = runBatchJob(jobs[i]);
             }
-        }
-    }
-
-    // Copy constructor
-    BigNum(const BigNum &other) : digits(other.digits), is_negative(other.is_negative) {}
+        };
 
-    // Assignment operator
-    BigNum &operator=(const BigNum &other)
-    {
-        if (this != &other)
+        vector<thread> pool;
+        for (unsigned t = 1; t < workers && t < jobs.size(); t++)
         {
-            digits = other.digits;
-            is_negative = other.is_negative;
+            pool.emplace_back(work);
+        }
+        work();
+        for (thread &t : pool)
+        {
+            t.join();
         }
-        return *this;
-    }
 
-    // Check if number is zero
-    bool isZero() const
-    {
-        return digits.size() == 1 && digits[0] == 0;
+        for (const string &result : results)
+        {
+            cout << result << '\n';
+        }
     }
 
-    // Check if number is one
-    bool isOne() const
-    {
-        return !is_negative && digits.size() == 1 && digits[0] == 1;
-    }
+    cout.flush();
+    return 0;
+}
 
-    // Comparison operators
-    bool operator==(const BigNum &other) const
-    {
-        return is_negative == other.is_negative && digits == other.digits;
-    }
+#if CALCULATOR_HAVE_SERVE
+/**
+ * Server mode: answers BigNumRpc frames (see bignum_rpc.hpp) on a Unix
+ * domain socket. Each connection has a reader thread that decodes requests
+ * and hands them to a shared thread pool; workers write each response as
+ * soon as it is ready, so a client can keep many requests in flight and
+ * gets them back out of order. Modular operations go through the shared
+ * BigNumModContextCache, so clients that reuse a modulus skip its
+ * precomputation. With --budget, a powmod or inverse that runs longer than
+ * the budget is abandoned and answered with RPC_DEADLINE_EXCEEDED.
+ */
+static const size_t MAX_IN_FLIGHT = 1024; // per connection, before the reader stops reading
 
-    bool operator!=(const BigNum &other) const
-    {
-        return !(*this == other);
-    }
+static volatile sig_atomic_t stopRequested = 0;
 
-    bool operator<(const BigNum &other) const
-    {
-        if (is_negative != other.is_negative)
-        {
-            return is_negative;
-        }
+static void requestStop(int)
+{
+    stopRequested = 1;
+}
 
-        if (is_negative)
-        {
-            return (-other) < (-(*this));
-        }
+static bool readFully(int fd, void *buffer, size_t size)
+{
+    char *p = static_cast<char *>(buffer);
+    while (size > 0)
+    {
+        ssize_t n = read(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
 
-        if (digits.size() != other.digits.size())
-        {
-            return digits.size() < other.digits.size();
-        }
+static bool writeFully(int fd, const void *buffer, size_t size)
+{
+    const char *p = static_cast<const char *>(buffer);
+    while (size > 0)
+    {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
 
-        for (int i = digits.size() - 1; i >= 0; i--)
-        {
-            if (digits[i] != other.digits[i])
-            {
-                return digits[i] < other.digits[i];
-            }
-        }
+class Connection
+{
+private:
+    int fd;
+    mutex writeLock;
+    mutex flightLock;
+    condition_variable landed;
+    size_t inFlight;
 
-        return false;
-    }
+public:
+    explicit Connection(int socket) : fd(socket), inFlight(0) {}
+    ~Connection() { close(fd); }
 
-    bool operator<=(const BigNum &other) const
-    {
-        return *this < other || *this == other;
-    }
+    int socket() const { return fd; }
 
-    bool operator>(const BigNum &other) const
+    void send(const vector<uint8_t> &frame)
     {
-        return !(*this <= other);
+        lock_guard<mutex> guard(writeLock);
+        writeFully(fd, frame.data(), frame.size()); // a vanished peer is noticed by the reader
     }
 
-    bool operator>=(const BigNum &other) const
+    void takeOff()
     {
-        return !(*this < other);
+        unique_lock<mutex> guard(flightLock);
+        landed.wait(guard, [this]
+                    { return inFlight < MAX_IN_FLIGHT; });
+        inFlight++;
     }
 
-    // Unary minus
-    BigNum operator-() const
+    void land()
     {
-        BigNum result(*this);
-        if (!result.isZero())
         {
-            result.is_negative = !result.is_negative;
+            lock_guard<mutex> guard(flightLock);
+            inFlight--;
         }
-        return result;
+        landed.notify_one();
     }
+};
 
-    // Addition
-    BigNum operator+(const BigNum &other) const
+// budget bounds powmod and inverse, which can run long on huge operands; zero means none
+static BigNumRpcFrame evaluate(const BigNumRpcFrame &request, chrono::milliseconds budget)
+{
+    BigNumRpcFrame response;
+    response.id = request.id;
+    response.code = RPC_OK;
+    if (BigNumRpc::arity(request.code) != (int)request.operands.size())
     {
-        if (is_negative == other.is_negative)
-        {
-            // Same sign: add magnitudes
-            BigNum result;
-            result.is_negative = is_negative;
-            result.digits.clear();
-
-            int carry = 0;
-            int maxSize = max(digits.size(), other.digits.size());
-
-            for (int i = 0; i < maxSize || carry; i++)
-            {
-                int sum = carry;
-                if (i < digits.size())
-                    sum += digits[i];
-                if (i < other.digits.size())
-                    sum += other.digits[i];
-
-                result.digits.push_back(sum % 10);
-                carry = sum / 10;
-            }
-
-            result.removeLeadingZeros();
-            if (result.isZero())
-                result.is_negative = false;
-
-            return result;
-        }
-        else
-        {
-            // Different signs: subtract magnitudes
-            if (is_negative)
-            {
-                return other - (-(*this));
-            }
-            else
-            {
-                return *this - (-other);
-            }
-        }
+        response.code = RPC_BAD_REQUEST;
+        return response;
     }
 
-    // Subtraction
-    BigNum operator-(const BigNum &other) const
+    const vector<BigNum> &x = request.operands;
+    BigNumStopToken stop;
+    if (budget.count() > 0)
+        stop = stop.withTimeout(budget);
+    try
     {
-        if (is_negative != other.is_negative)
-        {
-            // Different signs: add magnitudes
-            return *this + (-other);
-        }
-
-        if (is_negative)
-        {
-            // Both negative: -a - (-b) = b - a
-            return (-other) - (-(*this));
-        }
-
-        // Both positive
-        if (*this < other)
-        {
-            return -(other - *this);
-        }
-
-        BigNum result;
-        result.digits.clear();
-
-        int borrow = 0;
-        for (int i = 0; i < digits.size(); i++)
-        {
-            int diff = digits[i] - borrow;
-            if (i < other.digits.size())
+        switch (request.code)
+        {
+        case RPC_PING:
+            return response;
+        case RPC_ADD:
+            response.operands.push_back(x[0] + x[1]);
+            return response;
+        case RPC_SUB:
+            response.operands.push_back(x[0] - x[1]);
+            return response;
+        case RPC_MUL:
+            response.operands.push_back(x[0] * x[1]);
+            return response;
+        }
+
+        // Everything else divides by its last operand
+        if (x.back().isZero())
+        {
+            response.code = RPC_DIVISION_BY_ZERO;
+            return response;
+        }
+        switch (request.code)
+        {
+        case RPC_DIV:
+            response.operands.push_back(x[0] / x[1]);
+            break;
+        case RPC_MOD:
+            response.operands.push_back(x[0] % x[1]);
+            break;
+        case RPC_ADDMOD:
+            response.operands.push_back(x[0].addMod(x[1], x[2]));
+            break;
+        case RPC_MULMOD:
+            response.operands.push_back(x[0].mulMod(x[1], x[2]));
+            break;
+        case RPC_POWMOD:
+            response.operands.push_back(x[0].powMod(x[1], x[2], stop));
+            break;
+        case RPC_INVERSE:
+            try
             {
-                diff -= other.digits[i];
+                response.operands.push_back(x[0].modInverse(x[1], stop));
             }
-
-            if (diff < 0)
+            catch (const BigNumCancelled &)
             {
-                diff += 10;
-                borrow = 1;
+                throw;
             }
-            else
+            catch (const runtime_error &)
             {
-                borrow = 0;
+                response.code = RPC_NO_INVERSE;
             }
-
-            result.digits.push_back(diff);
+            break;
         }
-
-        result.removeLeadingZeros();
-        return result;
     }
-
-    // Multiplication
-    BigNum operator*(const BigNum &other) const
+    catch (const BigNumDeadlineExceeded &)
     {
-        BigNum result;
-        result.digits.assign(digits.size() + other.digits.size(), 0);
-        result.is_negative = is_negative ^ other.is_negative;
-
-        for (int i = 0; i < digits.size(); i++)
-        {
-            for (int j = 0; j < other.digits.size(); j++)
-            {
-                result.digits[i + j] += digits[i] * other.digits[j];
-                result.digits[i + j + 1] += result.digits[i + j] / 10;
-                result.digits[i + j] %= 10;
-            }
-        }
-
-        result.removeLeadingZeros();
-        if (result.isZero())
-            result.is_negative = false;
-
-        return result;
+        response.operands.clear();
+        response.code = RPC_DEADLINE_EXCEEDED;
     }
-
-    // Division (integer division)
-    BigNum operator/(const BigNum &divisor) const
+    catch (const exception &)
     {
-        if (divisor.isZero())
-        {
-            throw runtime_error("Division by zero");
-        }
-
-        if (isZero())
-            return BigNum(0);
-
-        BigNum dividend(*this);
-        dividend.is_negative = false;
-        BigNum div(divisor);
-        div.is_negative = false;
-
-        if (dividend < div)
-            return BigNum(0);
-
-        BigNum quotient(0);
-        BigNum remainder(0);
-
-        for (int i = digits.size() - 1; i >= 0; i--)
-        {
-            remainder = remainder * BigNum(10) + BigNum(digits[i]);
-
-            int count = 0;
-            while (remainder >= div)
-            {
-                remainder = remainder - div;
-                count++;
-            }
-
-            quotient.digits.insert(quotient.digits.begin(), count);
-        }
-
-        quotient.removeLeadingZeros();
-        quotient.is_negative = is_negative ^ divisor.is_negative;
-        if (quotient.isZero())
-            quotient.is_negative = false;
-
-        return quotient;
+        response.operands.clear();
+        response.code = RPC_FAILED;
     }
+    return response;
+}
 
-    // Modulo operation
-    BigNum operator%(const BigNum &divisor) const
-    {
-        if (divisor.isZero())
-        {
-            throw runtime_error("Division by zero");
-        }
-
-        BigNum quotient = *this / divisor;
-        BigNum remainder = *this - quotient * divisor;
+static void serveConnection(shared_ptr<Connection> connection, BigNumThreadPool &pool, chrono::milliseconds budget)
+{
+    vector<uint8_t> body;
+    while (true)
+    {
+        uint32_t length;
+        if (!readFully(connection->socket(), &length, sizeof length))
+            break;
+        if (length < BigNumRpc::HEADER_SIZE || length > BigNumRpc::MAX_FRAME)
+            break; // not speaking the protocol: drop the connection
+        body.resize(length);
+        if (!readFully(connection->socket(), body.data(), length))
+            break;
+
+        BigNumRpcFrame request;
+        try
+        {
+            request = BigNumRpc::decode(body.data(), body.size());
+        }
+        catch (const exception &)
+        {
+            BigNumRpcFrame response;
+            memcpy(&response.id, body.data(), 4);
+            response.code = RPC_BAD_REQUEST;
+            vector<uint8_t> frame;
+            BigNumRpc::encode(frame, response);
+            connection->send(frame);
+            continue;
+        }
+
+        connection->takeOff();
+        auto task = make_shared<BigNumRpcFrame>(std::move(request));
+        pool.submit([connection, task, budget]
+                    {
+                        vector<uint8_t> frame;
+                        BigNumRpc::encode(frame, evaluate(*task, budget));
+                        connection->send(frame);
+                        connection->land();
+                    });
+    }
+    shutdown(connection->socket(), SHUT_RDWR);
+}
 
-        // Ensure remainder is positive for modular arithmetic
-        if (remainder.is_negative)
-        {
-            remainder = remainder + (divisor.is_negative ? -divisor : divisor);
-        }
+struct Reader
+{
+    shared_ptr<Connection> connection;
+    thread worker;
+    atomic<bool> done;
 
-        return remainder;
-    }
+    Reader() : done(false) {}
+};
 
-    // Modular addition: (a + b) mod m
-    BigNum addMod(const BigNum &b, const BigNum &m) const
+int runServer(const string &path, size_t threads, chrono::milliseconds budget)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof address.sun_path)
     {
-        return (*this + b) % m;
+        cerr << "Error: socket path too long: " << path << endl;
+        return 1;
     }
+    memcpy(address.sun_path, path.c_str(), path.size());
 
-    // Modular multiplication: (a * b) mod m
-    BigNum mulMod(const BigNum &b, const BigNum &m) const
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path.c_str()); // a stale socket from an earlier run
+    if (listener < 0 || ::bind(listener, (sockaddr *)&address, sizeof address) != 0 || listen(listener, 128) != 0)
     {
-        return (*this * b) % m;
+        cerr << "Error: cannot listen on " << path << ": " << strerror(errno) << endl;
+        if (listener >= 0)
+            close(listener);
+        return 1;
     }
 
-    // Fast modular exponentiation: (base^exp) mod m
-    BigNum powMod(const BigNum &exp, const BigNum &m) const
-    {
-        if (m.isOne())
-            return BigNum(0);
-
-        BigNum result(1);
-        BigNum base = *this % m;
-        BigNum e(exp);
-
-        while (!e.isZero())
-        {
-            if (e.digits[0] & 1)
-            { // if e is odd
-                result = result.mulMod(base, m);
-            }
-            e = e / BigNum(2);
-            base = base.mulMod(base, m);
-        }
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
 
-        return result;
-    }
+    BigNumThreadPool pool(threads);
+    list<unique_ptr<Reader>> readers;
+    cerr << "Serving on " << path << " with " << pool.size() << " worker threads" << endl;
 
-    // Extended Euclidean Algorithm
-    static BigNum extendedGCD(const BigNum &a, const BigNum &b, BigNum &x, BigNum &y)
+    while (!stopRequested)
     {
-        if (b.isZero())
+        // Poll with a timeout so a signal delivered to another thread is still seen
+        pollfd waiting = {listener, POLLIN, 0};
+        if (poll(&waiting, 1, 200) <= 0)
+            continue;
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0)
+            continue;
+
+        for (auto it = readers.begin(); it != readers.end();)
         {
-            x = BigNum(1);
-            y = BigNum(0);
-            return a;
+            if ((*it)->done)
+            {
+                (*it)->worker.join();
+                it = readers.erase(it);
+            }
+            else
+                ++it;
         }
 
-        BigNum x1, y1;
-        BigNum gcd = extendedGCD(b, a % b, x1, y1);
-
-        x = y1;
-        y = x1 - (a / b) * y1;
-
-        return gcd;
+        unique_ptr<Reader> reader(new Reader());
+        reader->connection = make_shared<Connection>(client);
+        Reader *r = reader.get();
+        r->worker = thread([r, &pool, budget]
+                           {
+                               serveConnection(r->connection, pool, budget);
+                               r->done = true;
+                           });
+        readers.push_back(std::move(reader));
     }
 
-    // Modular inverse: find x such that (a * x) ≡ 1 (mod m)
-    BigNum modInverse(const BigNum &m) const
+    close(listener);
+    unlink(path.c_str());
+    for (unique_ptr<Reader> &reader : readers)
     {
-        BigNum x, y;
-        BigNum gcd = extendedGCD(*this % m, m, x, y);
-
-        if (!gcd.isOne())
-        {
-            throw runtime_error("Modular inverse does not exist");
-        }
-
-        BigNum result = x % m;
-        if (result.is_negative)
-        {
-            result = result + m;
-        }
-
-        return result;
+        shutdown(reader->connection->socket(), SHUT_RDWR);
+        reader->worker.join();
     }
+    BigNumModCacheStats cache = BigNumModContextCache::shared().stats();
+    cerr << "Server stopped (modulus contexts: " << cache.hits << " hits, " << cache.misses << " misses, "
+         << cache.evictions << " evictions)" << endl;
+    return 0;
+}
+#endif
 
-    // Get bit length of the number
-    int getBitLength() const
+int main(int argc, char *argv[])
+{
+    if (argc > 1 && string(argv[1]) == "--batch")
     {
-        if (isZero())
-            return 1;
+        // Unsynchronized, untied streams: output is flushed once per block
+        ios::sync_with_stdio(false);
+        cin.tie(nullptr);
 
-        BigNum temp(*this);
-        temp.is_negative = false;
-
-        int bits = 0;
-        BigNum two(2);
-
-        while (!temp.isZero())
+        if (argc > 2)
         {
-            temp = temp / two;
-            bits++;
+            ifstream file(argv[2]);
+            if (!file)
+            {
+                cerr << "Error: cannot open " << argv[2] << endl;
+                return 1;
+            }
+            return runBatch(file);
         }
-
-        return bits;
+        return runBatch(cin);
     }
 
-    // Convert to string
-    string toString() const
+    if (argc > 1 && string(argv[1]) == "--serve")
     {
-        string result;
-
-        if (is_negative && !isZero())
+#if CALCULATOR_HAVE_SERVE
+        if (argc < 3)
         {
-            result += "-";
+            cerr << "Usage: " << argv[0] << " --serve SOCKET_PATH [--threads N] [--budget MS]" << endl;
+            return 2;
         }
-
-        for (int i = digits.size() - 1; i >= 0; i--)
+        size_t threads = 0;
+        long budget = 0;
+        for (int i = 3; i + 1 < argc; i += 2)
         {
-            result += (digits[i] + '0');
+            string option = argv[i];
+            if (option == "--threads")
+                threads = strtoul(argv[i + 1], nullptr, 10);
+            else if (option == "--budget")
+                budget = strtol(argv[i + 1], nullptr, 10);
         }
-
-        return result;
-    }
-
-    // Print the number
-    void print() const
-    {
-        cout << toString() << endl;
-    }
-
-    // Input operator
-    friend istream &operator>>(istream &is, BigNum &num)
-    {
-        string str;
-        is >> str;
-        num = BigNum(str);
-        return is;
-    }
-
-    // Output operator
-    friend ostream &operator<<(ostream &os, const BigNum &num)
-    {
-        os << num.toString();
-        return os;
-    }
-};
-
-// Demo function to show the capabilities
-void demonstrateBigNum()
-{
-    cout << "=== BigNum Library Demonstration ===" << endl;
-    cout << "Supporting very large integers for cryptographic operations" << endl
-         << endl;
-
-    // Test basic operations
-    cout << "1. Basic Operations:" << endl;
-    BigNum a("12345678901234567890");
-    BigNum b("98765432109876543210");
-
-    cout << "a = " << a << endl;
-    cout << "b = " << b << endl;
-    cout << "a + b = " << a + b << endl;
-    cout << "b - a = " << b - a << endl;
-    cout << "a * b = " << a * b << endl;
-    cout << endl;
-
-    // Test modular operations
-    cout << "2. Modular Operations:" << endl;
-    BigNum m("1000000007");
-    cout << "m = " << m << " (modulus)" << endl;
-    cout << "a mod m = " << a % m << endl;
-    cout << "b mod m = " << b % m << endl;
-    cout << "(a + b) mod m = " << a.addMod(b, m) << endl;
-    cout << "(a * b) mod m = " << a.mulMod(b, m) << endl;
-    cout << endl;
-
-    // Test modular inverse
-    cout << "3. Modular Inverse:" << endl;
-    BigNum small_a("123");
-    BigNum small_m("1009"); // prime modulus
-    try
-    {
-        BigNum inv = small_a.modInverse(small_m);
-        cout << "Inverse of " << small_a << " mod " << small_m << " = " << inv << endl;
-        cout << "Verification: (" << small_a << " * " << inv << ") mod " << small_m << " = "
-             << small_a.mulMod(inv, small_m) << endl;
-    }
-    catch (const exception &e)
-    {
-        cout << "Error: " << e.what() << endl;
+        return runServer(argv[2], threads, chrono::milliseconds(budget));
+#else
+        cerr << "Error: --serve needs Unix domain sockets" << endl;
+        return 1;
+#endif
     }
-    cout << endl;
 
-    // Test large number representation
-    cout << "4. Large Number Representation:" << endl;
-    string large_512_bit = "13407807929942597099574024998205846127479365820592393377723561443721764030073546976801874298166903427690031858186486050853753882811946569946433649006084095";
-    BigNum large_num(large_512_bit);
-    cout << "512-bit number: " << large_num << endl;
-    cout << "Bit length: " << large_num.getBitLength() << " bits" << endl;
-    cout << endl;
-
-    // Test modular exponentiation
-    cout << "5. Modular Exponentiation:" << endl;
-    BigNum base("12345");
-    BigNum exp("67890");
-    BigNum mod_exp("1000000009");
-    cout << base << "^" << exp << " mod " << mod_exp << " = " << base.powMod(exp, mod_exp) << endl;
-    cout << endl;
-
-    cout << "=== All tests completed successfully! ===" << endl;
-}
-
-int main()
-{
     srand(time(nullptr));
 
     cout << "BigNum Library for Public Key Cryptosystems" << endl;
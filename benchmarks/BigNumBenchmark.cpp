@@ -0,0 +1,605 @@
+#include "bignum.hpp"
+#include "bignum_float.hpp"
+#include "bignum_series.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/**
+ * BigNum Benchmark Suite
+ *
+ * Times every BigNum operation, plus BigFloat and pi by binary splitting
+ * at a precision equal to the operand size and factorial of the size
+ * itself, at 256 .. 8192 bits and 1M bits, in the style of Google
+ * Benchmark: each case is repeated with a growing iteration count until it
+ * runs for at least --min-time seconds, then reports ns/op, ops/s and
+ * allocations per op: allocs/op counts digit allocations on the calling
+ * thread through BigNum::threadAllocations(), including those the limb pool
+ * serves without touching the heap, and heap/op counts every global
+ * operator new in the process. --json writes the same
+ * numbers in a stable format for diffing across commits.
+ *
+ * Usage: BigNumBenchmark [--filter SUBSTR] [--min-time SECONDS]
+ *                        [--max-bits BITS] [--json FILE] [--list] [--perf]
+ *                        [--assert-zero-alloc]
+ *
+ * Some operations are skipped above a per-operation size ceiling where a
+ * single call would take minutes with the current kernels; --max-bits
+ * replaces every ceiling with the given limit.
+ *
+ * --perf (Linux) also reads hardware counters through perf_event_open
+ * around each measured batch and reports IPC, branch misses per op and
+ * L1D/LLC misses per limb (decimal digit of the first operand).
+ *
+ * --assert-zero-alloc runs only the cases that must not touch the heap
+ * (in-place updates into preallocated storage, and a context's mulMod into
+ * an output parameter) and exits with status 1 if
+ * any of them allocates.
+ */
+
+// ---------------------------------------------------------------------------
+// Heap counting: every global operator new in this process is counted. Digit
+// allocations come from BigNum::threadAllocations(), since the limb pool
+// serves most of them without reaching operator new.
+
+static atomic<unsigned long long> g_allocations(0);
+
+void *operator new(size_t size)
+{
+    g_allocations.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+// ---------------------------------------------------------------------------
+
+// ---------------------------------------------------------------------------
+// Hardware counters via perf_event_open (Linux only)
+
+enum PerfCounter
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_COUNT
+};
+
+class PerfCounters
+{
+private:
+    int fds[PERF_COUNT];
+    double values[PERF_COUNT];
+
+#if defined(__linux__)
+    static int openCounter(uint32_t type, uint64_t config)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof attr);
+        attr.size = sizeof attr;
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+
+public:
+    PerfCounters()
+    {
+        for (int i = 0; i < PERF_COUNT; i++)
+        {
+            fds[i] = -1;
+            values[i] = -1;
+        }
+    }
+
+    ~PerfCounters()
+    {
+#if defined(__linux__)
+        for (int i = 0; i < PERF_COUNT; i++)
+        {
+            if (fds[i] >= 0)
+                close(fds[i]);
+        }
+#endif
+    }
+
+    // Open every counter the PMU offers; returns false (with a reason) if none
+    bool open(string &error)
+    {
+#if defined(__linux__)
+        const uint64_t l1dReadMiss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        fds[PERF_CYCLES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        if (fds[PERF_CYCLES] < 0)
+        {
+            error = strerror(errno);
+            if (errno == EACCES || errno == EPERM)
+                error += " (check /proc/sys/kernel/perf_event_paranoid)";
+            return false;
+        }
+        fds[PERF_INSTRUCTIONS] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds[PERF_BRANCH_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        fds[PERF_L1D_MISSES] = openCounter(PERF_TYPE_HW_CACHE, l1dReadMiss);
+        fds[PERF_LLC_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        return true;
+#else
+        error = "perf_event_open is only available on Linux";
+        return false;
+#endif
+    }
+
+    void start()
+    {
+#if defined(__linux__)
+        for (int i = 0; i < PERF_COUNT; i++)
+        {
+            if (fds[i] >= 0)
+            {
+                ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    // Stop counting and latch the values, scaled up if the PMU was multiplexed
+    void stop()
+    {
+#if defined(__linux__)
+        for (int i = 0; i < PERF_COUNT; i++)
+        {
+            if (fds[i] >= 0)
+                ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (int i = 0; i < PERF_COUNT; i++)
+        {
+            uint64_t data[3]; // value, time enabled, time running
+            values[i] = -1;
+            if (fds[i] >= 0 && read(fds[i], data, sizeof data) == (ssize_t)sizeof data && data[2] > 0)
+                values[i] = (double)data[0] * data[1] / data[2];
+        }
+#endif
+    }
+
+    // Latched value, or -1 if the counter is not available
+    double value(int counter) const
+    {
+        return values[counter];
+    }
+};
+
+// Keep a result alive so the compiler cannot drop the benchmarked call
+template <typename T>
+static void keep(const T &value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static const void *volatile sink;
+    sink = &value;
+#endif
+}
+
+// Operands shared by all cases of one size
+struct Operands
+{
+    int bits;
+    BigNum a, b;    // bits-sized operands
+    BigNum half;    // bits/2-sized divisor
+    BigNum m;       // bits-sized odd modulus
+    BigNum e;       // bits-sized exponent
+    BigNum unit;    // invertible modulo m
+    shared_ptr<const BigNumModContext> context; // of m
+    string text;    // decimal text of a
+    BigFloat fa, fb; // a and b as BigFloats of bits precision
+    mutable BigNum acc; // accumulator with capacity for in-place cases
+};
+
+struct Case
+{
+    string name;
+    int maxBits; // default size ceiling
+    function<void(const Operands &)> run;
+    bool zeroAlloc; // must not allocate once operands are built
+};
+
+struct Result
+{
+    string name;
+    int bits;
+    unsigned long long iterations;
+    double nsPerOp;
+    double allocsPerOp; // digit allocations, pool hits included
+    double bytesPerOp;
+    double heapAllocsPerOp; // global operator new
+    double counters[PERF_COUNT]; // per op; -1 when not measured
+    size_t limbs;
+};
+
+static BigNum randomBigNum(mt19937_64 &rng, int bits, bool odd = false)
+{
+    int digits = max(1, (int)ceil(bits * log10(2.0)) - 1);
+    string text(digits, '0');
+    text[0] = '1' + rng() % 9;
+    for (int i = 1; i < digits; i++)
+    {
+        text[i] = '0' + rng() % 10;
+    }
+    if (odd)
+        text[digits - 1] = "1379"[rng() % 4];
+    return BigNum(text);
+}
+
+static Operands makeOperands(int bits, mt19937_64 &rng, bool needInverse)
+{
+    Operands ops;
+    ops.bits = bits;
+    ops.a = randomBigNum(rng, bits);
+    ops.b = randomBigNum(rng, bits);
+    ops.half = randomBigNum(rng, max(64, bits / 2));
+    ops.m = randomBigNum(rng, bits, true);
+    ops.e = randomBigNum(rng, bits);
+    ops.text = ops.a.toString();
+    ops.fa = BigFloat(ops.a, bits);
+    ops.fb = BigFloat(ops.b, bits);
+    ops.context = make_shared<BigNumModContext>(ops.m);
+    ops.acc.reserve(2 * ops.text.size()); // a and b have the same digit count
+
+    // Only search for an invertible element where modInverse will be run
+    while (needInverse)
+    {
+        ops.unit = randomBigNum(rng, bits) % ops.m;
+        try
+        {
+            ops.unit.modInverse(ops.m);
+            break;
+        }
+        catch (const exception &)
+        {
+        }
+    }
+    return ops;
+}
+
+static vector<Case> makeCases()
+{
+    const int ALL = INT_MAX;
+    vector<Case> cases;
+    cases.push_back({"add", ALL, [](const Operands &o) { keep(o.a + o.b); }, false});
+    cases.push_back({"addInPlace", ALL, [](const Operands &o) { o.acc = o.a; keep(o.acc += o.b); }, true});
+    cases.push_back({"subInPlace", ALL, [](const Operands &o) { o.acc = o.b; keep(o.acc -= o.a); }, true});
+    cases.push_back({"sub", ALL, [](const Operands &o) { keep(o.a - o.b); }, false});
+    cases.push_back({"mul", ALL, [](const Operands &o) { keep(o.a * o.b); }, false});
+    cases.push_back({"div", 8192, [](const Operands &o) { keep(o.a / o.half); }, false});
+    cases.push_back({"mod", 8192, [](const Operands &o) { keep(o.a % o.half); }, false});
+    cases.push_back({"addMod", 8192, [](const Operands &o) { keep(o.a.addMod(o.b, o.m)); }, false});
+    cases.push_back({"mulMod", 8192, [](const Operands &o) { keep(o.a.mulMod(o.b, o.m)); }, false});
+    cases.push_back({"mulModInPlace", 8192, [](const Operands &o) { o.context->mulMod(o.a, o.b, o.acc); keep(o.acc); },
+                     true});
+    cases.push_back({"powMod", 512, [](const Operands &o) { keep(o.a.powMod(o.e, o.m)); }, false});
+    cases.push_back({"powModConstTime", 4096, [](const Operands &o) { keep(o.a.powModConstTime(o.e, o.m)); }, false});
+    cases.push_back({"powModLadder", 4096, [](const Operands &o) { keep(o.a.powModLadder(o.e, o.m)); }, false});
+    cases.push_back({"gcd", 4096, [](const Operands &o) { keep(BigNum::gcd(o.a, o.b)); }, false});
+    cases.push_back({"modInverse", 512, [](const Operands &o) { keep(o.unit.modInverse(o.m)); }, false});
+    cases.push_back({"floatMul", 8192, [](const Operands &o) { keep(o.fa * o.fb); }, false});
+    cases.push_back({"floatDiv", 8192, [](const Operands &o) { keep(o.fa / o.fb); }, false});
+    cases.push_back({"floatSqrt", 8192, [](const Operands &o) { keep(o.fa.sqrt()); }, false});
+    // End to end: binary splitting multiplies at every size up to the result's
+    cases.push_back({"seriesPi", 8192, [](const Operands &o) { keep(BigNumSeries::pi(o.bits)); }, false});
+    cases.push_back({"factorial", 8192, [](const Operands &o) { keep(BigNum::factorial((uint64_t)o.bits)); }, false});
+    cases.push_back({"getBitLength", 4096, [](const Operands &o) { keep(o.a.getBitLength()); }, false});
+    cases.push_back({"toString", ALL, [](const Operands &o) { keep(o.a.toString()); }, false});
+    cases.push_back({"parse", ALL, [](const Operands &o) { keep(BigNum(o.text)); }, false});
+    return cases;
+}
+
+// Run one case with a growing iteration count until it takes minTime seconds
+static Result runCase(const Case &c, const Operands &ops, double minTime, PerfCounters *perf)
+{
+    typedef chrono::steady_clock Clock;
+    unsigned long long iterations = 1;
+
+    while (true)
+    {
+        BigNumAllocationCount before = BigNum::threadAllocations();
+        unsigned long long heapAllocs = g_allocations.load();
+        if (perf)
+            perf->start();
+        Clock::time_point start = Clock::now();
+        for (unsigned long long i = 0; i < iterations; i++)
+        {
+            c.run(ops);
+        }
+        double elapsed = chrono::duration<double>(Clock::now() - start).count();
+        if (perf)
+            perf->stop();
+        // Before building the result, whose name may outgrow the small-string buffer
+        heapAllocs = g_allocations.load() - heapAllocs;
+        BigNumAllocationCount after = BigNum::threadAllocations();
+
+        if (elapsed >= minTime || iterations >= (1ULL << 40))
+        {
+            Result r;
+            r.name = c.name + "/" + to_string(ops.bits);
+            r.bits = ops.bits;
+            r.iterations = iterations;
+            r.nsPerOp = elapsed * 1e9 / iterations;
+            r.allocsPerOp = (double)(after.allocations - before.allocations) / iterations;
+            r.bytesPerOp = (double)(after.bytes - before.bytes) / iterations;
+            r.heapAllocsPerOp = (double)heapAllocs / iterations;
+            r.limbs = ops.text.size();
+            for (int k = 0; k < PERF_COUNT; k++)
+            {
+                double total = perf ? perf->value(k) : -1;
+                r.counters[k] = total < 0 ? -1 : total / iterations;
+            }
+            return r;
+        }
+
+        // Same growth rule as Google Benchmark: aim 40% past the target, at most 10x
+        double multiplier = elapsed > 0 ? minTime * 1.4 / elapsed : 10.0;
+        multiplier = min(10.0, max(multiplier, 2.0));
+        iterations = (unsigned long long)(iterations * multiplier);
+    }
+}
+
+static string jsonEscape(const string &text)
+{
+    string out;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static void writeJson(const string &path, const vector<Result> &results, double minTime)
+{
+    ofstream out(path.c_str());
+    if (!out)
+        throw runtime_error("Cannot write " + path);
+
+    char date[64];
+    time_t now = time(nullptr);
+    strftime(date, sizeof date, "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    out << "{\n  \"context\": {\n";
+    out << "    \"date\": \"" << date << "\",\n";
+    out << "    \"num_cpus\": " << thread::hardware_concurrency() << ",\n";
+#if defined(__VERSION__)
+    out << "    \"compiler\": \"" << jsonEscape(__VERSION__) << "\",\n";
+#endif
+#if defined(__OPTIMIZE__)
+    out << "    \"optimized\": true,\n";
+#else
+    out << "    \"optimized\": false,\n";
+#endif
+    out << "    \"min_time\": " << minTime << "\n  },\n";
+    out << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result &r = results[i];
+        char line[512];
+        snprintf(line, sizeof line,
+                 "    {\"name\": \"%s\", \"bits\": %d, \"iterations\": %llu, \"real_time\": %.3f, "
+                 "\"time_unit\": \"ns\", \"items_per_second\": %.3f, \"allocs_per_op\": %.3f, "
+                 "\"bytes_per_op\": %.1f, \"heap_allocs_per_op\": %.3f}%s\n",
+                 jsonEscape(r.name).c_str(), r.bits, r.iterations, r.nsPerOp, 1e9 / r.nsPerOp,
+                 r.allocsPerOp, r.bytesPerOp, r.heapAllocsPerOp, i + 1 < results.size() ? "," : "");
+        if (r.counters[PERF_CYCLES] >= 0)
+        {
+            // Splice the hardware counters in before the closing brace
+            string entry = line;
+            size_t brace = entry.rfind('}');
+            const char *names[PERF_COUNT] = {"cycles_per_op", "instructions_per_op", "branch_misses_per_op",
+                                             "l1d_misses_per_op", "llc_misses_per_op"};
+            string extra;
+            for (int k = 0; k < PERF_COUNT; k++)
+            {
+                if (r.counters[k] < 0)
+                    continue;
+                snprintf(line, sizeof line, ", \"%s\": %.3f", names[k], r.counters[k]);
+                extra += line;
+            }
+            if (r.counters[PERF_INSTRUCTIONS] >= 0)
+            {
+                snprintf(line, sizeof line, ", \"ipc\": %.3f", r.counters[PERF_INSTRUCTIONS] / r.counters[PERF_CYCLES]);
+                extra += line;
+            }
+            if (r.counters[PERF_L1D_MISSES] >= 0)
+            {
+                snprintf(line, sizeof line, ", \"l1d_misses_per_limb\": %.4f", r.counters[PERF_L1D_MISSES] / r.limbs);
+                extra += line;
+            }
+            if (r.counters[PERF_LLC_MISSES] >= 0)
+            {
+                snprintf(line, sizeof line, ", \"llc_misses_per_limb\": %.4f", r.counters[PERF_LLC_MISSES] / r.limbs);
+                extra += line;
+            }
+            entry.insert(brace, extra);
+            out << entry;
+        }
+        else
+        {
+            out << line;
+        }
+    }
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char *argv[])
+{
+    string filter, jsonPath;
+    double minTime = 0.2;
+    int maxBits = 0;
+    bool list = false;
+    bool usePerf = false;
+    bool assertZeroAlloc = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc)
+            filter = argv[++i];
+        else if (arg == "--min-time" && i + 1 < argc)
+            minTime = atof(argv[++i]);
+        else if (arg == "--max-bits" && i + 1 < argc)
+            maxBits = atoi(argv[++i]);
+        else if (arg == "--json" && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (arg == "--list")
+            list = true;
+        else if (arg == "--perf")
+            usePerf = true;
+        else if (arg == "--assert-zero-alloc")
+            assertZeroAlloc = true;
+        else
+        {
+            cerr << "Usage: " << argv[0]
+                 << " [--filter SUBSTR] [--min-time SECONDS] [--max-bits BITS] [--json FILE] [--list] [--perf]"
+                 << " [--assert-zero-alloc]" << endl;
+            return 2;
+        }
+    }
+
+    const int sizes[] = {256, 512, 1024, 2048, 4096, 8192, 1 << 20};
+    vector<Case> cases = makeCases();
+    vector<Result> results;
+    vector<string> allocating; // zero-allocation cases that allocated
+
+    PerfCounters counters;
+    PerfCounters *perf = nullptr;
+    if (usePerf && !list)
+    {
+        string error;
+        if (counters.open(error))
+            perf = &counters;
+        else
+            cerr << "Hardware counters unavailable: " << error << endl;
+    }
+
+    if (!list)
+    {
+        printf("%-22s %16s %12s %16s %12s %12s", "Benchmark", "Time", "Iterations", "ops/s", "allocs/op", "heap/op");
+        if (perf)
+            printf(" %8s %12s %10s %10s", "IPC", "br-miss/op", "L1D/limb", "LLC/limb");
+        printf("\n%s\n", string(perf ? 139 : 95, '-').c_str());
+    }
+
+    try
+    {
+        for (int bits : sizes)
+        {
+            vector<const Case *> selected;
+            for (const Case &c : cases)
+            {
+                string name = c.name + "/" + to_string(bits);
+                int ceiling = maxBits > 0 ? maxBits : c.maxBits;
+                if (bits <= ceiling && name.find(filter) != string::npos && (c.zeroAlloc || !assertZeroAlloc))
+                    selected.push_back(&c);
+            }
+            if (selected.empty())
+                continue;
+
+            if (list)
+            {
+                for (const Case *c : selected)
+                {
+                    printf("%s/%d\n", c->name.c_str(), bits);
+                }
+                continue;
+            }
+
+            bool needInverse = false;
+            for (const Case *c : selected)
+            {
+                needInverse |= c->name == "modInverse";
+            }
+
+            mt19937_64 rng(bits); // fixed seed per size so runs are comparable
+            Operands ops = makeOperands(bits, rng, needInverse);
+
+            for (const Case *c : selected)
+            {
+                Result r = runCase(*c, ops, minTime, perf);
+                printf("%-22s %13.0f ns %12llu %16.1f %12.1f %12.1f", r.name.c_str(), r.nsPerOp, r.iterations,
+                       1e9 / r.nsPerOp, r.allocsPerOp, r.heapAllocsPerOp);
+                if (perf)
+                {
+                    const double *k = r.counters;
+                    printf(" %8.2f %12.1f %10.3f %10.3f",
+                           k[PERF_INSTRUCTIONS] >= 0 ? k[PERF_INSTRUCTIONS] / k[PERF_CYCLES] : NAN,
+                           k[PERF_BRANCH_MISSES] >= 0 ? k[PERF_BRANCH_MISSES] : NAN,
+                           k[PERF_L1D_MISSES] >= 0 ? k[PERF_L1D_MISSES] / r.limbs : NAN,
+                           k[PERF_LLC_MISSES] >= 0 ? k[PERF_LLC_MISSES] / r.limbs : NAN);
+                }
+                printf("\n");
+                fflush(stdout);
+                results.push_back(r);
+                if (assertZeroAlloc && (r.allocsPerOp > 0 || r.heapAllocsPerOp > 0))
+                    allocating.push_back(r.name);
+            }
+        }
+
+        if (!jsonPath.empty())
+            writeJson(jsonPath, results, minTime);
+
+        for (const string &name : allocating)
+        {
+            cerr << "FAIL: " << name << " allocated on a zero-allocation path" << endl;
+        }
+        if (!allocating.empty())
+            return 1;
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
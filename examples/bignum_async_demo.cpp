@@ -0,0 +1,90 @@
+/**
+ * bignum_async_demo - awaiting BigNum operations from C++20 coroutines
+ *
+ * Tests a Mersenne prime and its neighbour for primality with progress
+ * reports, runs a modular exponentiation and a multiplication, cancels an
+ * exponentiation through its stop token, and stops another at a deadline.
+ * The coroutine type here is the smallest one that works; an event loop
+ * would bring its own.
+ *
+ *   g++ -std=c++20 -Iinclude examples/bignum_async_demo.cpp -L build -lbignum -pthread
+ */
+
+#include "bignum_async.hpp"
+
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Starts eagerly and signals a future when the coroutine body finishes
+struct Job
+{
+    struct promise_type
+    {
+        promise<void> done;
+
+        Job get_return_object() { return Job{done.get_future()}; }
+        suspend_never initial_suspend() noexcept { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() { done.set_value(); }
+        void unhandled_exception() { done.set_exception(current_exception()); }
+    };
+
+    future<void> finished;
+};
+
+static Job run()
+{
+    BigNum mersenne(1);
+    for (int i = 0; i < 521; i++)
+    {
+        mersenne = mersenne * BigNum(2);
+    }
+    mersenne = mersenne - BigNum(1);
+
+    int reports = 0;
+    bool prime = co_await BigNumAsync::isPrime(mersenne, 10, BigNumStopToken(), [&](double) { reports++; });
+    cout << "2^521 - 1 prime: " << (prime ? "yes" : "no") << " (" << reports << " progress reports)" << endl;
+    prime = co_await BigNumAsync::isPrime(mersenne + BigNum(2), 10);
+    cout << "2^521 + 1 prime: " << (prime ? "yes" : "no") << endl;
+
+    BigNum r = co_await BigNumAsync::powMod(BigNum(3), mersenne - BigNum(1), mersenne);
+    cout << "3^(p-1) mod p: " << r << endl;
+
+    BigNum square = co_await BigNumAsync::mul(mersenne, mersenne);
+    cout << "p^2 has " << square.toString().size() << " digits" << endl;
+
+    BigNumStopSource stop;
+    stop.requestStop();
+    try
+    {
+        co_await BigNumAsync::powMod(BigNum(3), mersenne, mersenne, stop.token());
+        cout << "powMod finished" << endl;
+    }
+    catch (const BigNumCancelled &e)
+    {
+        cout << "powMod: " << e.what() << endl;
+    }
+
+    // The synchronous overloads take the same tokens; this one would need
+    // about a second, so its 1 ms budget runs out after a few exponent bits
+    BigNum cube = square * mersenne;
+    try
+    {
+        cube.powMod(cube - BigNum(1), cube + BigNum(2), BigNumStopToken().withTimeout(chrono::milliseconds(1)));
+        cout << "powMod finished" << endl;
+    }
+    catch (const BigNumDeadlineExceeded &e)
+    {
+        cout << "powMod within 1 ms: " << e.what() << endl;
+    }
+}
+
+int main()
+{
+    run().finished.get();
+    return 0;
+}
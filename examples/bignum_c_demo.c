@@ -0,0 +1,100 @@
+/**
+ * bignum_c_demo - the C ABI from plain C
+ *
+ * Textbook RSA with n = 61 * 53: encrypts a batch of messages through the
+ * packed-buffer entry point, decrypts them through handles, and shows how
+ * errors and buffer sizing are reported.
+ *
+ *   cc -Iinclude examples/bignum_c_demo.c -L build -lbignum -lstdc++ -lpthread
+ */
+
+#include "bignum_c.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define COUNT 4
+
+static void check(int status, const char *what)
+{
+    if (status != BN_OK)
+    {
+        fprintf(stderr, "%s: %s\n", what, bn_status_string(status));
+        exit(1);
+    }
+}
+
+static void print(const char *label, const bn_num *n)
+{
+    char text[64];
+    size_t len;
+    check(bn_get_str(n, text, sizeof text, &len), "bn_get_str");
+    printf("%s%s\n", label, text);
+}
+
+int main(void)
+{
+    bn_num *n = bn_new(), *e = bn_new(), *d = bn_new(), *x = bn_new();
+    bn_mod_ctx *ctx;
+    check(bn_set_i64(n, 61 * 53), "bn_set_i64");
+    check(bn_set_i64(e, 17), "bn_set_i64");
+    check(bn_set_str(d, "2753"), "bn_set_str");
+    check(bn_mod_ctx_new(&ctx, n), "bn_mod_ctx_new");
+
+    /* Encrypt: messages and exponents packed as 2-byte big-endian values */
+    const unsigned messages[COUNT] = {65, 123, 1000, 3232};
+    uint8_t plain[2 * COUNT], exps[2 * COUNT], cipher[2 * COUNT];
+    for (int i = 0; i < COUNT; i++)
+    {
+        plain[2 * i] = (uint8_t)(messages[i] >> 8);
+        plain[2 * i + 1] = (uint8_t)messages[i];
+        exps[2 * i] = 0;
+        exps[2 * i + 1] = 17;
+    }
+    check(bn_batch_powmod_bytes(cipher, 2, plain, 2, exps, 2, COUNT, ctx), "bn_batch_powmod_bytes");
+
+    /* Decrypt through handles */
+    bn_num *c[COUNT], *m[COUNT];
+    const bn_num *ds[COUNT];
+    for (int i = 0; i < COUNT; i++)
+    {
+        c[i] = bn_new();
+        m[i] = bn_new();
+        ds[i] = d;
+        check(bn_set_bytes(c[i], cipher + 2 * i, 2, 0), "bn_set_bytes");
+        print("cipher ", c[i]);
+    }
+    check(bn_batch_powmod(m, (const bn_num *const *)c, ds, COUNT, ctx), "bn_batch_powmod");
+    for (int i = 0; i < COUNT; i++)
+    {
+        print("plain ", m[i]);
+    }
+
+    /* d * e = 1 (mod phi) */
+    check(bn_set_i64(x, 60 * 52), "bn_set_i64");
+    check(bn_modinverse(x, e, x), "bn_modinverse");
+    print("inverse ", x);
+
+    /* Failures come back as status codes, never as exceptions */
+    check(bn_set_i64(x, 61), "bn_set_i64");
+    printf("inverse of 61 mod n: %s\n", bn_status_string(bn_modinverse(x, x, n)));
+    bn_num *zero = bn_new();
+    printf("mod 0: %s\n", bn_status_string(bn_mod(x, n, zero)));
+    size_t needed;
+    int status = bn_get_bytes(n, NULL, 0, &needed);
+    printf("sizing: %s, %zu bytes\n", bn_status_string(status), needed);
+    printf("cmp with NULL: %d %d\n", bn_cmp(NULL, zero), bn_cmp(zero, NULL));
+
+    for (int i = 0; i < COUNT; i++)
+    {
+        bn_free(c[i]);
+        bn_free(m[i]);
+    }
+    bn_mod_ctx_free(ctx);
+    bn_free(zero);
+    bn_free(x);
+    bn_free(d);
+    bn_free(e);
+    bn_free(n);
+    return 0;
+}
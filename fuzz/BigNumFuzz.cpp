@@ -0,0 +1,108 @@
+#include "bignum.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+using namespace std;
+
+#include "BigNumReference.h"
+
+/**
+ * BigNumFuzz - libFuzzer entry point for differential testing
+ *
+ * Input layout: byte 0 holds the operand signs (bits 0-3 for a, b, m, e),
+ * bytes 1-3 the lengths of a, b and m; the remaining bytes become a, b, m
+ * and e in that order, one decimal digit per byte (byte % 10), with e
+ * capped at 40 digits. The raw tail is also decoded as big-endian bytes,
+ * and a and b (capped at 100 digits) are checked in Field25519 and as the
+ * fractions a/m and b/e in BigRational (a zero denominator becomes 1),
+ * in BigFloat with exponents and precision taken from bytes 1-3, and as
+ * coefficients of a BigNumSeries split; bytes 1-3 also pick n and k for
+ * the combinatorial functions.
+ *
+ * Build with libFuzzer:
+ *   clang++ -std=c++17 -O1 -g -fsanitize=fuzzer,address,undefined -Iinclude \
+ *       fuzz/BigNumFuzz.cpp src/bignum.cpp src/bignum_rational.cpp src/bignum_float.cpp src/bignum_series.cpp
+ *
+ * Without libFuzzer, -DBIGNUM_FUZZ_MAIN adds a main() that replays the
+ * files named on the command line (e.g. a saved crash or a corpus).
+ */
+
+static const size_t MAX_EXPONENT_DIGITS = 40;
+static const size_t MAX_FIELD_DIGITS = 100;
+
+static string digitsFrom(const uint8_t *data, size_t len, bool negative)
+{
+    string text(negative ? "-" : "");
+    for (size_t i = 0; i < len; i++)
+    {
+        text += (char)('0' + data[i] % 10);
+    }
+    return len ? text : "0";
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < 4)
+        return 0;
+
+    const uint8_t signs = data[0];
+    const uint8_t *tail = data + 4;
+    size_t remaining = size - 4;
+
+    string operands[4];
+    for (int i = 0; i < 4; i++)
+    {
+        size_t len = i < 3 ? min<size_t>(data[1 + i], remaining) : min(remaining, MAX_EXPONENT_DIGITS);
+        operands[i] = digitsFrom(tail, len, (signs >> i) & 1);
+        tail += len;
+        remaining -= len;
+    }
+
+    try
+    {
+        BigNumDifferential::checkArithmetic(operands[0], operands[1], operands[2], operands[3]);
+        BigNumDifferential::checkBytes(data + 4, size - 4);
+
+        string a = operands[0].substr(0, MAX_FIELD_DIGITS), b = operands[1].substr(0, MAX_FIELD_DIGITS);
+        BigNumDifferential::checkField25519(a.empty() || a == "-" ? "0" : a, b.empty() || b == "-" ? "0" : b);
+        BigNumDifferential::checkRational(a.empty() || a == "-" ? "0" : a, BigNum(operands[2]).isZero() ? "1" : operands[2],
+                                          b.empty() || b == "-" ? "0" : b, BigNum(operands[3]).isZero() ? "1" : operands[3]);
+        BigNumDifferential::checkFloat(a.empty() || a == "-" ? "0" : a, data[1] % 61 - 30,
+                                       b.empty() || b == "-" ? "0" : b, data[2] % 61 - 30, 1 + data[3] * 2);
+        BigNumDifferential::checkSeries((signed char)data[1], (signed char)data[2], 1 + data[3], (signed char)data[0],
+                                        data[1], 1 + size % 64, data[0] % 4);
+        BigNumDifferential::checkCombinatorics(data[1] + data[2], data[3]);
+    }
+    catch (const exception &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        abort();
+    }
+    return 0;
+}
+
+#ifdef BIGNUM_FUZZ_MAIN
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        ifstream in(argv[i], ios::binary);
+        if (!in)
+        {
+            cerr << "Cannot open " << argv[i] << endl;
+            return 1;
+        }
+        string input((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+    }
+    cout << "Replayed " << argc - 1 << " input(s)" << endl;
+    return 0;
+}
+#endif
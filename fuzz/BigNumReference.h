@@ -0,0 +1,1153 @@
+#ifndef BIGNUM_REFERENCE_H
+#define BIGNUM_REFERENCE_H
+
+// Include after bignum.hpp and `using namespace std;`
+
+#include "bignum_float.hpp"
+#include "bignum_rational.hpp"
+#include "bignum_series.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <sstream>
+
+#ifdef BIGNUM_HAVE_GMP
+#include <gmpxx.h>
+#endif
+
+/**
+ * RefInt - slow reference integer for differential testing
+ *
+ * Deliberately shares nothing with BigNum: binary magnitude in 32-bit
+ * words (least significant first, no leading zero words, zero is empty),
+ * schoolbook multiplication and bit-at-a-time long division. It is only
+ * meant to be obviously correct, never fast.
+ */
+class RefInt
+{
+public:
+    typedef vector<uint32_t> Limbs;
+
+    bool neg;
+    Limbs mag;
+
+    RefInt() : neg(false) {}
+
+    explicit RefInt(uint32_t value) : neg(false)
+    {
+        if (value)
+            mag.push_back(value);
+    }
+
+    static void trim(Limbs &x)
+    {
+        while (!x.empty() && x.back() == 0)
+            x.pop_back();
+    }
+
+    static int compareMag(const Limbs &a, const Limbs &b)
+    {
+        if (a.size() != b.size())
+            return a.size() < b.size() ? -1 : 1;
+        for (size_t i = a.size(); i-- > 0;)
+        {
+            if (a[i] != b[i])
+                return a[i] < b[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    static Limbs addMag(const Limbs &a, const Limbs &b)
+    {
+        Limbs r(max(a.size(), b.size()) + 1, 0);
+        uint64_t carry = 0;
+        for (size_t i = 0; i + 1 < r.size(); i++)
+        {
+            carry += (uint64_t)(i < a.size() ? a[i] : 0) + (i < b.size() ? b[i] : 0);
+            r[i] = (uint32_t)carry;
+            carry >>= 32;
+        }
+        r.back() = (uint32_t)carry;
+        trim(r);
+        return r;
+    }
+
+    // a - b for |a| >= |b|
+    static Limbs subMag(const Limbs &a, const Limbs &b)
+    {
+        Limbs r(a.size(), 0);
+        int64_t borrow = 0;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            int64_t diff = (int64_t)a[i] - (i < b.size() ? b[i] : 0) - borrow;
+            borrow = diff < 0;
+            r[i] = (uint32_t)(diff + (borrow << 32));
+        }
+        trim(r);
+        return r;
+    }
+
+    static Limbs mulMag(const Limbs &a, const Limbs &b)
+    {
+        if (a.empty() || b.empty())
+            return Limbs();
+        Limbs r(a.size() + b.size(), 0);
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b.size(); j++)
+            {
+                carry += (uint64_t)a[i] * b[j] + r[i + j];
+                r[i + j] = (uint32_t)carry;
+                carry >>= 32;
+            }
+            r[i + b.size()] = (uint32_t)carry;
+        }
+        trim(r);
+        return r;
+    }
+
+    // Truncating long division, one quotient bit at a time
+    static void divModMag(const Limbs &a, const Limbs &b, Limbs &q, Limbs &r)
+    {
+        q.assign(a.size(), 0);
+        r.clear();
+        for (size_t bit = a.size() * 32; bit-- > 0;)
+        {
+            uint32_t carry = (a[bit / 32] >> (bit % 32)) & 1;
+            for (size_t i = 0; i < r.size(); i++)
+            {
+                uint32_t top = r[i] >> 31;
+                r[i] = (r[i] << 1) | carry;
+                carry = top;
+            }
+            if (carry)
+                r.push_back(carry);
+
+            if (compareMag(r, b) >= 0)
+            {
+                r = subMag(r, b);
+                q[bit / 32] |= 1u << (bit % 32);
+            }
+        }
+        trim(q);
+    }
+
+    bool isZero() const
+    {
+        return mag.empty();
+    }
+
+    RefInt normalized() const
+    {
+        RefInt r(*this);
+        if (r.mag.empty())
+            r.neg = false;
+        return r;
+    }
+
+    RefInt negated() const
+    {
+        RefInt r(*this);
+        r.neg = !r.neg;
+        return r.normalized();
+    }
+
+    RefInt magnitude() const
+    {
+        RefInt r(*this);
+        r.neg = false;
+        return r;
+    }
+
+    friend RefInt operator+(const RefInt &a, const RefInt &b)
+    {
+        RefInt r;
+        if (a.neg == b.neg)
+        {
+            r.mag = addMag(a.mag, b.mag);
+            r.neg = a.neg;
+        }
+        else if (compareMag(a.mag, b.mag) >= 0)
+        {
+            r.mag = subMag(a.mag, b.mag);
+            r.neg = a.neg;
+        }
+        else
+        {
+            r.mag = subMag(b.mag, a.mag);
+            r.neg = b.neg;
+        }
+        return r.normalized();
+    }
+
+    friend RefInt operator-(const RefInt &a, const RefInt &b)
+    {
+        return a + b.negated();
+    }
+
+    friend RefInt operator*(const RefInt &a, const RefInt &b)
+    {
+        RefInt r;
+        r.mag = mulMag(a.mag, b.mag);
+        r.neg = a.neg != b.neg;
+        return r.normalized();
+    }
+
+    // Quotient rounded toward zero (divisor must be non-zero)
+    friend RefInt operator/(const RefInt &a, const RefInt &b)
+    {
+        RefInt q;
+        Limbs rem;
+        divModMag(a.mag, b.mag, q.mag, rem);
+        q.neg = a.neg != b.neg;
+        return q.normalized();
+    }
+
+    // BigNum's remainder convention: a - trunc(a / d) * d, lifted into [0, |d|)
+    friend RefInt operator%(const RefInt &a, const RefInt &d)
+    {
+        RefInt r = a - (a / d) * d;
+        if (r.neg)
+            r = r + d.magnitude();
+        return r;
+    }
+
+    friend bool operator==(const RefInt &a, const RefInt &b)
+    {
+        return a.neg == b.neg && a.mag == b.mag;
+    }
+
+    // base^exp mod m for exp >= 0, m > 1
+    static RefInt powMod(const RefInt &base, const RefInt &exp, const RefInt &m)
+    {
+        RefInt result(1);
+        RefInt b = base % m;
+        for (size_t bit = 0; bit < exp.mag.size() * 32; bit++)
+        {
+            if ((exp.mag[bit / 32] >> (bit % 32)) & 1)
+                result = (result * b) % m;
+            b = (b * b) % m;
+        }
+        return result % m;
+    }
+
+    // Inverse in [0, m) for m > 1; returns false if gcd(a, m) != 1
+    static bool modInverse(const RefInt &a, const RefInt &m, RefInt &inverse)
+    {
+        RefInt oldR = a % m, r = m;
+        RefInt oldS(1), s;
+        while (!r.isZero())
+        {
+            RefInt q = oldR / r;
+            RefInt nextR = oldR - q * r;
+            RefInt nextS = oldS - q * s;
+            oldR = r;
+            r = nextR;
+            oldS = s;
+            s = nextS;
+        }
+        if (!(oldR == RefInt(1)))
+            return false;
+        inverse = oldS % m;
+        return true;
+    }
+
+    // Number of significant bits, 1 for zero (matching BigNum::getBitLength)
+    int bitLength() const
+    {
+        if (mag.empty())
+            return 1;
+        int bits = (int)(mag.size() - 1) * 32;
+        for (uint32_t top = mag.back(); top; top >>= 1)
+            bits++;
+        return bits;
+    }
+
+    static RefInt fromDecimal(const string &text)
+    {
+        RefInt r;
+        size_t i = 0;
+        bool negative = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+            negative = text[i++] == '-';
+        for (; i < text.size(); i++)
+        {
+            uint64_t carry = text[i] - '0';
+            for (size_t k = 0; k < r.mag.size(); k++)
+            {
+                carry += (uint64_t)r.mag[k] * 10;
+                r.mag[k] = (uint32_t)carry;
+                carry >>= 32;
+            }
+            if (carry)
+                r.mag.push_back((uint32_t)carry);
+        }
+        r.neg = negative;
+        return r.normalized();
+    }
+
+    string toDecimal() const
+    {
+        if (mag.empty())
+            return "0";
+        string out;
+        Limbs x = mag;
+        while (!x.empty())
+        {
+            uint64_t rem = 0;
+            for (size_t i = x.size(); i-- > 0;)
+            {
+                uint64_t cur = (rem << 32) | x[i];
+                x[i] = (uint32_t)(cur / 10);
+                rem = cur % 10;
+            }
+            trim(x);
+            out += (char)('0' + rem);
+        }
+        if (neg)
+            out += '-';
+        return string(out.rbegin(), out.rend());
+    }
+
+    static RefInt fromBytes(const uint8_t *data, size_t len)
+    {
+        RefInt r;
+        r.mag.assign((len + 3) / 4, 0);
+        for (size_t i = 0; i < len; i++)
+        {
+            size_t bit = (len - 1 - i) * 8;
+            r.mag[bit / 32] |= (uint32_t)data[i] << (bit % 32);
+        }
+        trim(r.mag);
+        return r;
+    }
+
+    // Big-endian magnitude, empty for zero
+    vector<uint8_t> toBytes() const
+    {
+        vector<uint8_t> out;
+        for (size_t i = mag.size() * 4; i-- > 0;)
+        {
+            uint8_t byte = (mag[i / 4] >> (8 * (i % 4))) & 0xFF;
+            if (!out.empty() || byte)
+                out.push_back(byte);
+        }
+        return out;
+    }
+};
+
+/**
+ * BigNumDifferential - runs BigNum operations against RefInt (and GMP)
+ *
+ * Each check builds both sides from the same input independently and
+ * throws runtime_error naming the first operation whose results differ.
+ * Multiplication is additionally run with the Karatsuba tier forced on and
+ * forced off, so every tier is compared on the same operands.
+ */
+class BigNumDifferential
+{
+private:
+    static const size_t MAX_POWMOD_DIGITS = 80; // keeps the slow paths fast enough to fuzz
+
+    // Temporarily replaces BigNum's tuning, e.g. to force an algorithm tier
+    class TuningOverride
+    {
+    private:
+        BigNumTuning saved;
+
+    public:
+        explicit TuningOverride(size_t karatsubaThreshold) : saved(BigNum::tuning())
+        {
+            BigNumTuning tuning = saved;
+            tuning.karatsubaThreshold = karatsubaThreshold;
+            BigNum::setTuning(tuning);
+        }
+
+        ~TuningOverride()
+        {
+            BigNum::setTuning(saved);
+        }
+    };
+
+    template <typename Op>
+    static string attempt(Op op)
+    {
+        try
+        {
+            return op().toString();
+        }
+        catch (const exception &)
+        {
+            return "<error>";
+        }
+    }
+
+    static void expect(const string &what, const string &inputs, const string &got, const string &want)
+    {
+        if (got != want)
+            throw runtime_error(what + " mismatch for " + inputs + ": got " + got + ", expected " + want);
+    }
+
+    static string readFile(const string &path)
+    {
+        ifstream in(path.c_str(), ios::binary);
+        return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+
+    static void writeFile(const string &path, const string &data)
+    {
+        ofstream out(path.c_str(), ios::binary | ios::trunc);
+        out.write(data.data(), (streamsize)data.size());
+    }
+
+#ifdef BIGNUM_HAVE_GMP
+    static string gmpMod(const mpz_class &a, const mpz_class &d)
+    {
+        mpz_class r;
+        mpz_tdiv_r(r.get_mpz_t(), a.get_mpz_t(), d.get_mpz_t());
+        if (r < 0)
+            r += abs(d);
+        return r.get_str();
+    }
+#endif
+
+    // gcd of |a| and |b|
+    static RefInt refGcd(const RefInt &a, const RefInt &b)
+    {
+        RefInt x = a.magnitude(), y = b.magnitude();
+        while (!y.isZero())
+        {
+            RefInt r = x % y;
+            x = y;
+            y = r;
+        }
+        return x;
+    }
+
+    // n/d in lowest terms, formatted like BigRational::toString (d != 0)
+    static string refFraction(RefInt n, RefInt d)
+    {
+        if (d.neg)
+        {
+            n = n.negated();
+            d = d.negated();
+        }
+        RefInt g = refGcd(n, d);
+        n = n / g;
+        d = d / g;
+        return d == RefInt(1) ? n.toDecimal() : n.toDecimal() + "/" + d.toDecimal();
+    }
+
+    static RefInt refPow10(size_t n)
+    {
+        RefInt r(1), ten(10);
+        for (size_t i = 0; i < n; i++)
+            r = r * ten;
+        return r;
+    }
+
+    static size_t refDigits(const RefInt &n)
+    {
+        return n.magnitude().toDecimal().size();
+    }
+
+    // Largest s with s * s <= n, for n >= 0
+    static RefInt refIsqrt(const RefInt &n)
+    {
+        RefInt x = refPow10((refDigits(n) + 1) / 2), two(2);
+        for (;;)
+        {
+            RefInt y = (x + n / x) / two;
+            if (!(y - x).neg)
+                return x;
+            x = y;
+        }
+    }
+
+    // n * 10^e (plus a little more in magnitude if sticky) rounded to p
+    // digits, nearest with ties to even, formatted like describe()
+    static string refRound(const RefInt &n, int64_t e, bool sticky, size_t p)
+    {
+        RefInt m = n.magnitude();
+        if (m.isZero())
+            return "0e0";
+        size_t len = refDigits(m);
+        if (len > p)
+        {
+            RefInt unit = refPow10(len - p), q = m / unit;
+            RefInt half = (m % unit) * RefInt(2) - unit;
+            bool odd = !q.mag.empty() && (q.mag[0] & 1);
+            if (!half.neg && (!half.isZero() || sticky || odd))
+                q = q + RefInt(1);
+            m = q;
+            e += (int64_t)(len - p);
+        }
+        RefInt ten(10);
+        while ((m % ten).isZero())
+        {
+            m = m / ten;
+            e++;
+        }
+        return (n.neg ? "-" : "") + m.toDecimal() + "e" + to_string(e);
+    }
+
+    static string describe(const BigFloat &x)
+    {
+        return x.mantissa().toString() + "e" + to_string(x.exponent());
+    }
+
+    static RefInt refSigned(long long v)
+    {
+        return RefInt::fromDecimal(to_string(v));
+    }
+
+    // Fixed-point series at scale 10^digits; each term is floored once, so
+    // the result is low by at most one unit per term
+    static RefInt refArctanInverse(uint32_t x, size_t digits)
+    {
+        // The series does not shrink at x = 1; use Machin's pi/4 instead
+        if (x == 1)
+            return RefInt(4) * refArctanInverse(5, digits) - refArctanInverse(239, digits);
+        RefInt sum, power = refPow10(digits) / RefInt(x), x2 = RefInt(x) * RefInt(x);
+        for (uint32_t k = 0; !power.isZero(); k++)
+        {
+            RefInt term = power / RefInt(2 * k + 1);
+            sum = k % 2 ? sum - term : sum + term;
+            power = power / x2;
+        }
+        return sum;
+    }
+
+    static RefInt refE(size_t digits)
+    {
+        RefInt sum, term = refPow10(digits);
+        for (uint32_t k = 1; !term.isZero(); k++)
+        {
+            sum = sum + term;
+            term = term / RefInt(k);
+        }
+        return sum;
+    }
+
+    // sum 1/(k 2^k) over k >= 1
+    static RefInt refLog2(size_t digits)
+    {
+        RefInt sum, power = refPow10(digits) / RefInt(2);
+        for (uint32_t k = 1; !power.isZero(); k++)
+        {
+            sum = sum + power / RefInt(k);
+            power = power / RefInt(2);
+        }
+        return sum;
+    }
+
+    // x within half a unit in its last place of ref / 10^digits, give or
+    // take slack units of the reference
+    static void expectNear(const string &what, const string &inputs, const BigFloat &x, const RefInt &ref,
+                           size_t digits, size_t slack)
+    {
+        int64_t scale = x.exponent() + (int64_t)digits;
+        RefInt diff = (RefInt::fromDecimal(x.mantissa().toString()) * refPow10((size_t)scale) - ref).magnitude();
+        RefInt bound = refPow10((size_t)scale) + RefInt(2 * (uint32_t)slack);
+        if (!(bound - diff - diff).neg)
+            return;
+        throw runtime_error(what + " mismatch for " + inputs + ": got " + x.toString() + ", expected " +
+                            ref.toDecimal() + "e-" + to_string(digits));
+    }
+
+public:
+    /**
+     * Compares +, -, * (every tier), /, %, addMod, mulMod (also through a
+     * BigNumModContext, with its divide and in-place mulMod), gcd, getBitLength, text and byte round trips, and for
+     * m > 1 with at most MAX_POWMOD_DIGITS digits also powMod (with |e|,
+     * and for odd m its constant-time variants) and modInverse.
+     */
+    static void checkArithmetic(const string &aText, const string &bText, const string &mText, const string &eText)
+    {
+        const string inputs = "a=" + aText + " b=" + bText + " m=" + mText + " e=" + eText;
+        BigNum a(aText), b(bText), m(mText), e(eText);
+        RefInt ra = RefInt::fromDecimal(aText), rb = RefInt::fromDecimal(bText);
+        RefInt rm = RefInt::fromDecimal(mText), re = RefInt::fromDecimal(eText).magnitude();
+        const string error = "<error>";
+
+        expect("parse", inputs, a.toString(), ra.toDecimal());
+        expect("add", inputs, (a + b).toString(), (ra + rb).toDecimal());
+        expect("sub", inputs, (a - b).toString(), (ra - rb).toDecimal());
+        const string product = (ra * rb).toDecimal();
+        expect("mul", inputs, (a * b).toString(), product);
+        {
+            TuningOverride schoolbook((size_t)-1);
+            expect("mul (schoolbook)", inputs, (a * b).toString(), product);
+        }
+        {
+            TuningOverride karatsuba(4);
+            expect("mul (karatsuba)", inputs, (a * b).toString(), product);
+        }
+        BigNum sum(a);
+        sum += b;
+        expect("add in place", inputs, sum.toString(), (ra + rb).toDecimal());
+        const uint64_t allocationsBefore = BigNum::threadAllocations().allocations;
+        BigNum moved(std::move(sum));
+        expect("move allocations", inputs, to_string(BigNum::threadAllocations().allocations - allocationsBefore), "0");
+        expect("moved-from", inputs, sum == BigNum(0) && sum.isZero() ? sum.toString() : "<invalid>", "0");
+        expect("moved-from sub", inputs, (sum - b).toString(), (RefInt::fromDecimal("0") - rb).toDecimal());
+        expect("moved-from mul", inputs, (a * sum).toString(), "0");
+        expect("moved-from add in place", inputs, (sum += a).toString(), ra.toDecimal());
+
+        const bool divisible = !rb.isZero(), modulus = !rm.isZero();
+        expect("div", inputs, attempt([&] { return a / b; }), divisible ? (ra / rb).toDecimal() : error);
+        expect("mod", inputs, attempt([&] { return a % b; }), divisible ? (ra % rb).toDecimal() : error);
+        expect("addMod", inputs, attempt([&] { return a.addMod(b, m); }), modulus ? ((ra + rb) % rm).toDecimal() : error);
+        expect("mulMod", inputs, attempt([&] { return a.mulMod(b, m); }), modulus ? ((ra * rb) % rm).toDecimal() : error);
+        if (modulus)
+        {
+            BigNumModContext context(m);
+            expect("reduce (context)", inputs, context.reduce(a).toString(), (ra % rm).toDecimal());
+            expect("addMod (context)", inputs, context.addMod(a, b).toString(), ((ra + rb) % rm).toDecimal());
+            expect("mulMod (context)", inputs, context.mulMod(a, b).toString(), ((ra * rb) % rm).toDecimal());
+            BigNum out;
+            context.mulMod(a, b, out);
+            expect("mulMod into (context)", inputs, out.toString(), ((ra * rb) % rm).toDecimal());
+            // With room for the product it is formed and reduced in out
+            BigNum inPlace, reduced = context.reduce(a);
+            inPlace.reserve(aText.size() + bText.size());
+            context.mulMod(a, b, inPlace);
+            expect("mulMod in place (context)", inputs, inPlace.toString(), ((ra * rb) % rm).toDecimal());
+            context.mulMod(inPlace, reduced, inPlace);
+            expect("mulMod in place, aliased (context)", inputs, inPlace.toString(),
+                   ((((ra * rb) % rm) * (ra % rm)) % rm).toDecimal());
+            expect("divide (context)", inputs, context.divide(a).toString(), (ra / rm.magnitude()).toDecimal());
+            expect("gcd", inputs, BigNum::gcd(a, m).toString(), refGcd(ra, rm).toDecimal());
+        }
+        expect("getBitLength", inputs, to_string(a.getBitLength()), to_string(ra.bitLength()));
+
+        vector<uint8_t> bytes = a.toBytes();
+        if (bytes != ra.toBytes())
+            throw runtime_error("toBytes mismatch for " + inputs);
+        expect("fromBytes", inputs, BigNum::fromBytes(bytes.data(), bytes.size()).toString(),
+               ra.magnitude().toDecimal());
+
+        const bool smallModulus = !rm.neg && rm.bitLength() > 1 && mText.size() <= MAX_POWMOD_DIGITS;
+        string powmod, inverse;
+        if (smallModulus)
+        {
+            BigNum exponent(re.toDecimal());
+            powmod = RefInt::powMod(ra, re, rm).toDecimal();
+            expect("powMod", inputs, attempt([&] { return a.powMod(exponent, m); }), powmod);
+            if ((mText.back() - '0') % 2 == 1)
+            {
+                expect("powModConstTime", inputs, attempt([&] { return a.powModConstTime(exponent, m); }), powmod);
+                expect("powModLadder", inputs, attempt([&] { return a.powModLadder(exponent, m); }), powmod);
+            }
+
+            RefInt inv;
+            inverse = RefInt::modInverse(ra, rm, inv) ? inv.toDecimal() : error;
+            expect("modInverse", inputs, attempt([&] { return a.modInverse(m); }), inverse);
+        }
+
+#ifdef BIGNUM_HAVE_GMP
+        // Also hold the reference itself to account
+        mpz_class ga(aText), gb(bText), gm(mText), ge(re.toDecimal());
+        expect("add (GMP)", inputs, mpz_class(ga + gb).get_str(), (ra + rb).toDecimal());
+        expect("mul (GMP)", inputs, mpz_class(ga * gb).get_str(), product);
+        if (divisible)
+        {
+            mpz_class q;
+            mpz_tdiv_q(q.get_mpz_t(), ga.get_mpz_t(), gb.get_mpz_t());
+            expect("div (GMP)", inputs, q.get_str(), (ra / rb).toDecimal());
+            expect("mod (GMP)", inputs, gmpMod(ga, gb), (ra % rb).toDecimal());
+        }
+        if (modulus)
+            expect("mulMod (GMP)", inputs, gmpMod(ga * gb, gm), ((ra * rb) % rm).toDecimal());
+        if (smallModulus)
+        {
+            mpz_class r;
+            mpz_powm(r.get_mpz_t(), ga.get_mpz_t(), ge.get_mpz_t(), gm.get_mpz_t());
+            expect("powMod (GMP)", inputs, r.get_str(), powmod);
+            mpz_class reduced(gmpMod(ga, gm));
+            bool exists = mpz_invert(r.get_mpz_t(), reduced.get_mpz_t(), gm.get_mpz_t()) != 0;
+            expect("modInverse (GMP)", inputs, exists ? r.get_str() : error, inverse);
+        }
+#endif
+    }
+
+    /**
+     * Compares BigRational +, -, *, /, == and < for a/b and c/d (b, d
+     * non-zero), once with every result left unreduced and once with every
+     * operation taking the cross-gcd path; also parsing "a/b" and
+     * rejecting malformed text.
+     */
+    static void checkRational(const string &aText, const string &bText, const string &cText, const string &dText)
+    {
+        const string inputs = "x=" + aText + "/" + bText + " y=" + cText + "/" + dText;
+        RefInt a = RefInt::fromDecimal(aText), b = RefInt::fromDecimal(bText);
+        RefInt c = RefInt::fromDecimal(cText), d = RefInt::fromDecimal(dText);
+        RefInt cross = a * d - c * b;
+        bool crossNegative = cross.neg != (b.neg != d.neg); // sign of x - y
+        const size_t saved = BigRational::normalizeThreshold();
+        const size_t thresholds[] = {(size_t)-1, 0};
+
+        for (size_t threshold : thresholds)
+        {
+            BigRational::setNormalizeThreshold(threshold);
+            const string mode = threshold ? " (lazy)" : " (cross gcd)";
+            BigRational x{BigNum(aText), BigNum(bText)}, y{BigNum(cText), BigNum(dText)};
+            try
+            {
+                expect("rational parse" + mode, inputs, x.toString(), refFraction(a, b));
+                expect("rational add" + mode, inputs, (x + y).toString(), refFraction(a * d + c * b, b * d));
+                expect("rational sub" + mode, inputs, (x - y).toString(), refFraction(a * d - c * b, b * d));
+                expect("rational mul" + mode, inputs, (x * y).toString(), refFraction(a * c, b * d));
+                if (!c.isZero())
+                    expect("rational div" + mode, inputs, (x / y).toString(), refFraction(a * d, b * c));
+                expect("rational ==" + mode, inputs, to_string(x == y), to_string(cross.isZero()));
+                expect("rational <" + mode, inputs, to_string(x < y), to_string(!cross.isZero() && crossNegative));
+            }
+            catch (...)
+            {
+                BigRational::setNormalizeThreshold(saved);
+                throw;
+            }
+        }
+        BigRational::setNormalizeThreshold(saved);
+
+        // The text form, and near misses that must be rejected rather than skimmed
+        expect("rational text", inputs, attempt([&] { return BigRational(aText + "/" + bText); }), refFraction(a, b));
+        const string malformed[] = {"", "-", "/", "abc", aText + "/", "/" + bText, aText + "." + bText,
+                                    aText + "/" + bText + "/" + cText, aText + " ", "+" + aText, "--" + aText,
+                                    aText + "/0"};
+        for (const string &text : malformed)
+        {
+            expect("rational text", "\"" + text + "\"", attempt([&] { return BigRational(text); }), "<error>");
+        }
+
+#ifdef BIGNUM_HAVE_GMP
+        mpq_class gx{mpz_class(aText), mpz_class(bText)}, gy{mpz_class(cText), mpz_class(dText)};
+        gx.canonicalize();
+        gy.canonicalize();
+        expect("rational add (GMP)", inputs, mpq_class(gx + gy).get_str(), refFraction(a * d + c * b, b * d));
+        expect("rational mul (GMP)", inputs, mpq_class(gx * gy).get_str(), refFraction(a * c, b * d));
+#endif
+    }
+
+    /**
+     * Compares BigFloat add, sub, mul, div and sqrt of a * 10^ea and
+     * b * 10^eb, rounded to the given precision in bits, with the exactly
+     * computed result rounded by the reference; also parsing, comparisons,
+     * toBigNum and the toString round trip.
+     */
+    static void checkFloat(const string &aText, int64_t ea, const string &bText, int64_t eb, int bits)
+    {
+        const string inputs = "a=" + aText + "e" + to_string(ea) + " b=" + bText + "e" + to_string(eb) +
+                              " bits=" + to_string(bits);
+        const int exact = 1 << 16; // holds every operand digit
+        const size_t p = BigFloat::digitsForPrecision(bits);
+        RefInt a = RefInt::fromDecimal(aText), b = RefInt::fromDecimal(bText);
+        BigFloat x(aText + "e" + to_string(ea), exact), y(bText + "e" + to_string(eb), exact);
+
+        expect("float parse", inputs, describe(x), refRound(a, ea, false, BigFloat::digitsForPrecision(exact)));
+        const int64_t base = min(ea, eb);
+        RefInt as = a * refPow10((size_t)(ea - base)), bs = b * refPow10((size_t)(eb - base));
+        expect("float add", inputs, describe(BigFloat::add(x, y, bits)), refRound(as + bs, base, false, p));
+        expect("float sub", inputs, describe(BigFloat::sub(x, y, bits)), refRound(as - bs, base, false, p));
+        expect("float mul", inputs, describe(BigFloat::mul(x, y, bits)), refRound(a * b, ea + eb, false, p));
+
+        string quotient = "<error>", got = "<error>";
+        if (!b.isZero())
+        {
+            size_t s = p + 5 + refDigits(b);
+            RefInt n = a * refPow10(s), q = n / b;
+            quotient = refRound(q, ea - eb - (int64_t)s, !(n - q * b).isZero(), p);
+        }
+        try
+        {
+            got = describe(BigFloat::div(x, y, bits));
+        }
+        catch (const exception &)
+        {
+        }
+        expect("float div", inputs, got, quotient);
+
+        // Even exponent under the root, and at least 2p + 6 digits
+        size_t s = 2 * p + 6 + (size_t)((ea % 2 + 2) % 2);
+        RefInt n = a.magnitude() * refPow10(s), root = refIsqrt(n);
+        expect("float sqrt", inputs, describe(BigFloat::sqrt(x < BigFloat() ? -x : x, bits)),
+               refRound(root, (ea - (int64_t)s) / 2, !(root * root == n), p));
+
+        RefInt cross = as - bs;
+        expect("float ==", inputs, to_string(x == y), to_string(cross.isZero()));
+        expect("float <", inputs, to_string(x < y), to_string(cross.neg));
+        RefInt integer = ea >= 0 ? a * refPow10((size_t)ea) : a / refPow10((size_t)-ea);
+        expect("float toBigNum", inputs, x.toBigNum().toString(), integer.toDecimal());
+        expect("float toString", inputs, describe(BigFloat(x.toString(), exact)), describe(x));
+    }
+
+    /**
+     * Compares BigNumSeries::split over [begin, begin + count) of the terms
+     * p(n) = c0 + c1 n, q(n) = c2 + n, a(n) = c3 - n (c2 > 0), at the given
+     * fork depth, with the terms combined one at a time left to right.
+     */
+    static void checkSeries(long long c0, long long c1, long long c2, long long c3, uint64_t begin, uint64_t count,
+                            int depth)
+    {
+        const string inputs = "c=" + to_string(c0) + "," + to_string(c1) + "," + to_string(c2) + "," + to_string(c3) +
+                              " range=" + to_string(begin) + "+" + to_string(count) + " depth=" + to_string(depth);
+        BigNumSeries::Term term = [=](uint64_t n, BigNum &p, BigNum &q, BigNum &a)
+        {
+            p = BigNum(c0 + c1 * (long long)n);
+            q = BigNum(c2 + (long long)n);
+            a = BigNum(c3 - (long long)n);
+        };
+        BigNumSeries::Split s = BigNumSeries::split(term, begin, begin + count, depth);
+
+        RefInt p(1), q(1), t;
+        for (uint64_t n = begin; n < begin + count; n++)
+        {
+            RefInt pn = refSigned(c0 + c1 * (long long)n), qn = refSigned(c2 + (long long)n);
+            t = t * qn + p * refSigned(c3 - (long long)n) * pn;
+            p = p * pn;
+            q = q * qn;
+        }
+        expect("series P", inputs, s.p.toString(), p.toDecimal());
+        expect("series Q", inputs, s.q.toString(), q.toDecimal());
+        expect("series T", inputs, s.t.toString(), t.toDecimal());
+    }
+
+    /**
+     * Compares pi (against Machin's formula), e, log 2 and arctan(1/x) at
+     * the given precision with fixed-point reference series.
+     */
+    static void checkConstants(int bits, uint32_t x)
+    {
+        const string inputs = "bits=" + to_string(bits) + " x=" + to_string(x);
+        const size_t digits = BigFloat::digitsForPrecision(bits) + 10;
+        RefInt pi = RefInt(16) * refArctanInverse(5, digits) - RefInt(4) * refArctanInverse(239, digits);
+        expectNear("pi", inputs, BigNumSeries::pi(bits), pi, digits, 20 * digits);
+        expectNear("e", inputs, BigNumSeries::e(bits), refE(digits), digits, digits);
+        expectNear("log2", inputs, BigNumSeries::log2(bits), refLog2(digits), digits, 4 * digits);
+        expectNear("arctanInverse", inputs, BigNumSeries::arctanInverse(x, bits), refArctanInverse(x, digits), digits,
+                   4 * digits);
+    }
+
+    /**
+     * Compares factorial, primorial and doubleFactorial of n and
+     * binomial(n, k) with plain running products (primes by trial
+     * division), and with GMP.
+     */
+    static void checkCombinatorics(uint64_t n, uint64_t k)
+    {
+        const string inputs = "n=" + to_string(n) + " k=" + to_string(k);
+        RefInt factorial(1), primorial(1), doubleFactorial(1), falling(1), kFactorial(1);
+        for (uint64_t i = 2; i <= n; i++)
+        {
+            RefInt ri = RefInt::fromDecimal(to_string(i));
+            factorial = factorial * ri;
+            bool prime = true;
+            for (uint64_t d = 2; d * d <= i && prime; d++)
+                prime = i % d != 0;
+            if (prime)
+                primorial = primorial * ri;
+        }
+        for (uint64_t i = n; i >= 2; i -= 2)
+            doubleFactorial = doubleFactorial * RefInt::fromDecimal(to_string(i));
+        for (uint64_t i = 0; i < k && k <= n; i++)
+        {
+            falling = falling * RefInt::fromDecimal(to_string(n - i));
+            kFactorial = kFactorial * RefInt::fromDecimal(to_string(i + 1));
+        }
+        const string binomial = k <= n ? (falling / kFactorial).toDecimal() : "0";
+
+        expect("factorial", inputs, BigNum::factorial(n).toString(), factorial.toDecimal());
+        expect("primorial", inputs, BigNum::primorial(n).toString(), primorial.toDecimal());
+        expect("doubleFactorial", inputs, BigNum::doubleFactorial(n).toString(), doubleFactorial.toDecimal());
+        expect("binomial", inputs, BigNum::binomial(n, k).toString(), binomial);
+
+#ifdef BIGNUM_HAVE_GMP
+        mpz_class g;
+        mpz_fac_ui(g.get_mpz_t(), (unsigned long)n);
+        expect("factorial (GMP)", inputs, g.get_str(), factorial.toDecimal());
+        mpz_primorial_ui(g.get_mpz_t(), (unsigned long)n);
+        expect("primorial (GMP)", inputs, g.get_str(), primorial.toDecimal());
+        mpz_2fac_ui(g.get_mpz_t(), (unsigned long)n);
+        expect("doubleFactorial (GMP)", inputs, g.get_str(), doubleFactorial.toDecimal());
+        mpz_bin_uiui(g.get_mpz_t(), (unsigned long)n, (unsigned long)k);
+        expect("binomial (GMP)", inputs, g.get_str(), binomial);
+#endif
+    }
+
+    // binomial(n, k) for a large n and small k, which divides the falling
+    // product by k! instead of sieving up to n
+    static void checkBinomial(uint64_t n, uint64_t k)
+    {
+        const string inputs = "n=" + to_string(n) + " k=" + to_string(k);
+        RefInt falling(1), kFactorial(1);
+        for (uint64_t i = 0; i < k && k <= n; i++)
+        {
+            falling = falling * RefInt::fromDecimal(to_string(n - i));
+            kFactorial = kFactorial * RefInt::fromDecimal(to_string(i + 1));
+        }
+        expect("binomial", inputs, BigNum::binomial(n, k).toString(), k <= n ? (falling / kFactorial).toDecimal() : "0");
+    }
+
+    // Non-negative numbers decoded from raw big-endian bytes
+    static void checkBytes(const uint8_t *data, size_t len)
+    {
+        RefInt ref = RefInt::fromBytes(data, len);
+        BigNum value = BigNum::fromBytes(data, len);
+        expect("fromBytes", to_string(len) + " bytes", value.toString(), ref.toDecimal());
+        if (value.toBytes() != ref.toBytes())
+            throw runtime_error("toBytes mismatch for " + ref.toDecimal());
+    }
+
+    /**
+     * Writes the values to a BigNumArchive at path and reads them back
+     * through open() and operator[]; then damages a copy (a digit out of
+     * range, a negative zero, a misaligned index) and expects it to be
+     * rejected or normalized.
+     */
+    static void checkArchive(const vector<string> &texts, const string &path)
+    {
+        vector<BigNum> values(texts.begin(), texts.end());
+        BigNumArchive::write(path, values);
+        {
+            BigNumArchive archive = BigNumArchive::open(path);
+            expect("archive size", path, to_string(archive.size()), to_string(values.size()));
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                expect("archive entry", texts[i], archive[i].toString(), values[i].toString());
+            }
+        }
+
+        // One zero entry: flags at byte 32, its digit at byte 40
+        BigNumArchive::write(path, vector<BigNum>(1, BigNum(0)));
+        const string zero = readFile(path);
+        string damaged = zero;
+        damaged[32] = 1;
+        writeFile(path, damaged);
+        expect("archive negative zero", path, BigNumArchive::open(path)[0].toString(), "0");
+
+        damaged = zero;
+        damaged[40] = 10;
+        writeFile(path, damaged);
+        expect("archive digit range", path, attempt([&] { return BigNumArchive::open(path)[0]; }), "<error>");
+
+        damaged = zero;
+        damaged[16] += 4;
+        writeFile(path, damaged);
+        expect("archive index alignment", path, attempt([&] { return BigNumArchive::open(path)[0]; }), "<error>");
+        remove(path.c_str());
+    }
+
+    // Every way of parsing text (BigNum's string, C string, string_view and
+    // iterator constructors, and BigNumParser fed in the pieces that cuts
+    // splits it into) against the syntax read off the characters directly
+    static void checkParser(const string &text, const vector<size_t> &cuts)
+    {
+        const string inputs = "\"" + text + "\"";
+        string digits;
+        for (char c : text)
+        {
+            if (c >= '0' && c <= '9')
+                digits += c;
+        }
+        RefInt expected = RefInt::fromDecimal(digits.empty() ? "0" : digits);
+        if (!text.empty() && text[0] == '-' && !expected.isZero())
+            expected = RefInt() - expected;
+        const string want = expected.toDecimal();
+
+        expect("parse string", inputs, BigNum(text).toString(), want);
+        expect("parse C string", inputs, BigNum(text.c_str()).toString(), want);
+#if BIGNUM_HAVE_STRING_VIEW
+        expect("parse string_view", inputs, BigNum(string_view(text)).toString(), want);
+#endif
+        list<char> chars(text.begin(), text.end());
+        expect("parse bidirectional range", inputs, BigNum(chars.begin(), chars.end()).toString(), want);
+        istringstream stream(text);
+        expect("parse input range", inputs,
+               BigNum(istreambuf_iterator<char>(stream), istreambuf_iterator<char>()).toString(), want);
+
+        // Each piece goes in a different way: one char at a time, pointer and
+        // length, or string_view
+        BigNumParser parser;
+        size_t from = 0;
+        for (size_t i = 0; i <= cuts.size(); i++)
+        {
+            size_t to = i < cuts.size() ? min(cuts[i], text.size()) : text.size();
+            if (to < from)
+                to = from;
+            switch (i % 3)
+            {
+            case 0:
+                for (size_t j = from; j < to; j++)
+                {
+                    parser.feed(text[j]);
+                }
+                break;
+            case 1:
+                parser.feed(text.data() + from, to - from);
+                break;
+            default:
+#if BIGNUM_HAVE_STRING_VIEW
+                parser.feed(string_view(text.data() + from, to - from));
+#else
+                parser.feed(text.data() + from, to - from);
+#endif
+            }
+            from = to;
+        }
+        expect("parser digit count", inputs, to_string(parser.digitCount()), to_string(digits.size()));
+        expect("parser chunks", inputs, parser.finish().toString(), want);
+
+        // finish() resets: the same text again, in one piece
+        parser.feed(text.data(), text.size());
+        expect("parser reuse", inputs, parser.finish().toString(), want);
+    }
+
+    // fromFile/toFile in radix 10 and in radix, plus the mapped parser on
+    // radixDigits (digits valid in radix, either case) padded with spaces
+    // and a sign, and on files with nothing to parse
+    static void checkFiles(const string &text, int radix, const string &radixDigits, const string &path)
+    {
+        const string inputs = text + " radix " + to_string(radix) + " (" + radixDigits + ")";
+        const string error = "<error>";
+        BigNum value(text);
+        value.toFile(path);
+        expect("toFile text", inputs, readFile(path), value.toString() + "\n");
+        expect("fromFile", inputs, BigNum::fromFile(path).toString(), value.toString());
+        value.toFile(path, radix);
+        expect("fromFile radix round trip", inputs, BigNum::fromFile(path, radix).toString(), value.toString());
+
+        RefInt expected, base((uint32_t)radix);
+        for (char c : radixDigits)
+        {
+            int digit = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+            expected = expected * base + RefInt((uint32_t)digit);
+        }
+        const bool negative = radixDigits.size() % 2 == 1;
+        if (negative && !expected.isZero())
+            expected = RefInt() - expected;
+        writeFile(path, " \t\n" + string(negative ? "-" : "+") + radixDigits + "\r\n \n");
+        expect("fromFile radix", inputs, attempt([&] { return BigNum::fromFile(path, radix); }), expected.toDecimal());
+
+        const char *empty[] = {"", " \n\t\r\n", "-", "+\n", " - \n", "--1", "1 2"};
+        for (const char *content : empty)
+        {
+            writeFile(path, content);
+            expect("fromFile malformed", "\"" + string(content) + "\"", attempt([&] { return BigNum::fromFile(path); }),
+                   error);
+        }
+        if (radix < 36)
+        {
+            const char beyond = "0123456789abcdefghijklmnopqrstuvwxyz"[radix];
+            writeFile(path, radixDigits + beyond);
+            expect("fromFile digit beyond radix", inputs, attempt([&] { return BigNum::fromFile(path, radix); }), error);
+        }
+        remove(path.c_str());
+    }
+
+    // A radix-10 file longer than one 64 Ki-digit parallel chunk, including
+    // a bad digit that only a later chunk sees
+    static void checkLargeFile(const string &text, const string &path)
+    {
+        BigNum value(text);
+        value.toFile(path);
+        expect("large toFile", to_string(text.size()) + " digits", readFile(path), value.toString() + "\n");
+        expect("large fromFile", to_string(text.size()) + " digits", BigNum::fromFile(path).toString(),
+               value.toString());
+
+        string damaged = text;
+        damaged[damaged.size() - 1] = 'x';
+        writeFile(path, damaged);
+        expect("large fromFile bad digit", to_string(text.size()) + " digits",
+               attempt([&] { return BigNum::fromFile(path); }), "<error>");
+        remove(path.c_str());
+    }
+
+    // RFC 7748 section 5.2: the second single-call vector, then the iterated
+    // ladder (k = u = 9, each result becomes k and the old k becomes u)
+    // after 1 and 1,000 calls, also through the BigNum overload
+    static void checkX25519Vectors()
+    {
+        struct Hex
+        {
+            static void decode(const char *hex, uint8_t out[32])
+            {
+                for (int i = 0; i < 32; i++)
+                {
+                    out[i] = (uint8_t)stoi(string(hex + 2 * i, 2), nullptr, 16);
+                }
+            }
+            static string encode(const uint8_t in[32])
+            {
+                static const char digits[] = "0123456789abcdef";
+                string hex;
+                for (int i = 0; i < 32; i++)
+                {
+                    hex += digits[in[i] >> 4];
+                    hex += digits[in[i] & 15];
+                }
+                return hex;
+            }
+            // Little-endian bytes as a BigNum
+            static BigNum number(const uint8_t in[32])
+            {
+                uint8_t reversed[32];
+                reverse_copy(in, in + 32, reversed);
+                return BigNum::fromBytes(reversed, 32);
+            }
+        };
+
+        uint8_t scalar[32], u[32], out[32];
+        Hex::decode("4b66e9d4d1b4673c5ad22691957d6af5c11b6421e0ea01d42ca4169e7918ba0d", scalar);
+        Hex::decode("e5210f12786811d3f4b7959d0538ae2c31dbe7106fc03c3efc4cd549c715a493", u);
+        Field25519::x25519(out, scalar, u);
+        expect("X25519 vector", "RFC 7748 5.2", Hex::encode(out),
+               "95cbde9476e8907d7aade45cb4b873f88b595a68799fa152e6f8f7647aac7957");
+        // The BigNum overload takes u as a field element: decoding drops bit 255
+        u[31] &= 127;
+        expect("X25519 vector (BigNum)", "RFC 7748 5.2",
+               Field25519::x25519(Hex::number(scalar), Hex::number(u)).toString(),
+               "39566196721700740701373067725336211924689549479508623342842086701180565506965");
+
+        uint8_t k[32] = {9}, next[32];
+        memset(u, 0, 32);
+        u[0] = 9;
+        for (int i = 1; i <= 1000; i++)
+        {
+            Field25519::x25519(next, k, u);
+            memcpy(u, k, 32);
+            memcpy(k, next, 32);
+            if (i == 1)
+                expect("X25519 1 iteration", "RFC 7748 5.2", Hex::encode(k),
+                       "422c8e7a6227d7bca1350b3e2bb7279f7897b87bb6854b783c60e80311ae3079");
+        }
+        expect("X25519 1000 iterations", "RFC 7748 5.2", Hex::encode(k),
+               "684cf59ba83309552800ef566f2f4d3c1c3887c49360e3875f2eb94d99532c51");
+    }
+
+    // Field25519 arithmetic against the reference reduced modulo 2^255 - 19
+    static void checkField25519(const string &aText, const string &bText)
+    {
+        static const RefInt p = RefInt::fromDecimal(
+            "57896044618658097711785492504343953926634992332820282019728792003956564819949");
+        const string inputs = "a=" + aText + " b=" + bText;
+        RefInt ra = RefInt::fromDecimal(aText) % p, rb = RefInt::fromDecimal(bText) % p;
+        Field25519 fa{BigNum(aText)}, fb{BigNum(bText)};
+
+        expect("Field25519 reduce", inputs, fa.toBigNum().toString(), ra.toDecimal());
+        expect("Field25519 add", inputs, (fa + fb).toBigNum().toString(), ((ra + rb) % p).toDecimal());
+        expect("Field25519 sub", inputs, (fa - fb).toBigNum().toString(), ((ra - rb) % p).toDecimal());
+        expect("Field25519 mul", inputs, (fa * fb).toBigNum().toString(), ((ra * rb) % p).toDecimal());
+        expect("Field25519 square", inputs, fa.square().toBigNum().toString(), ((ra * ra) % p).toDecimal());
+        if (!ra.isZero())
+        {
+            RefInt inv = RefInt::fromDecimal(fa.invert().toBigNum().toString());
+            expect("Field25519 invert", inputs, ((ra * inv) % p).toDecimal(), "1");
+        }
+    }
+};
+
+#endif // BIGNUM_REFERENCE_H
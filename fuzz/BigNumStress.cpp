@@ -0,0 +1,239 @@
+#include "bignum.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#include "BigNumReference.h"
+
+/**
+ * BigNumStress - randomized cross-check of BigNum against RefInt (and GMP)
+ *
+ * Operand sizes cluster around the points where BigNum switches
+ * algorithm tier (1, 2, 3 digits and 1x, 2x, 4x, 8x the Karatsuba
+ * threshold, each +-1) with uniform sizes in between, and operand shapes
+ * include zero, one, 10^k, 10^k - 1 and 10^k + 1 besides random digits.
+ * BigFloat operands also come from the digits 0, 4, 5 and 9 only, so that
+ * rounding meets exact ties and near-ties. The first operand is also
+ * re-parsed from text with separators, whitespace and leading zeros mixed
+ * in, by every constructor and by BigNumParser fed in random pieces.
+ * The first iteration also checks X25519 against the RFC 7748 vectors.
+ * Odd iterations run with the Karatsuba threshold lowered to its minimum
+ * so that every operation goes through the recursive tier. Every eighth
+ * iteration also round-trips a BigNumArchive and fromFile/toFile text
+ * through scratch files in the working directory, and every 64th does the
+ * same for a text file longer than one parallel parse chunk.
+ *
+ * Usage: BigNumStress [--iterations N] [--seed S] [--max-digits D]
+ *
+ * Exits with status 1 and prints the operands on the first mismatch.
+ * Build with -DBIGNUM_HAVE_GMP and -lgmpxx -lgmp to add GMP as a third
+ * opinion.
+ */
+
+static const size_t MAX_SMALL_MODULUS_DIGITS = 80;
+
+static size_t pickSize(mt19937_64 &rng, size_t maxDigits)
+{
+    size_t t = BigNum::tuning().karatsubaThreshold;
+    const size_t boundaries[] = {1, 2, 3, t - 1, t, t + 1, 2 * t - 1, 2 * t, 2 * t + 1,
+                                 4 * t - 1, 4 * t, 4 * t + 1, 8 * t - 1, 8 * t, 8 * t + 1};
+    size_t count = sizeof boundaries / sizeof boundaries[0];
+    size_t size = rng() % 2 ? boundaries[rng() % count] : 1 + rng() % maxDigits;
+    return max<size_t>(1, min(size, maxDigits));
+}
+
+static string makeNumber(mt19937_64 &rng, size_t digits)
+{
+    string text;
+    switch (rng() % 8)
+    {
+    case 0:
+        text = rng() % 2 ? "0" : "1";
+        break;
+    case 1: // 10^k
+        text = "1" + string(digits - 1, '0');
+        break;
+    case 2: // 10^k - 1
+        text = string(digits, '9');
+        break;
+    case 3: // 10^k + 1
+        text = digits > 1 ? "1" + string(digits - 2, '0') + "1" : "2";
+        break;
+    default:
+        text.resize(digits);
+        text[0] = '1' + rng() % 9;
+        for (size_t i = 1; i < digits; i++)
+        {
+            text[i] = '0' + rng() % 10;
+        }
+    }
+    if (text != "0" && rng() % 4 == 0)
+        text = "-" + text;
+    return text;
+}
+
+// Half the time only digits 0, 4, 5 and 9, which put exact ties and runs
+// of nines under BigFloat's rounding digit
+static string makeFloatNumber(mt19937_64 &rng, size_t digits)
+{
+    if (rng() % 2)
+        return makeNumber(rng, digits);
+
+    string text(1, "459"[rng() % 3]);
+    for (size_t i = 1; i < digits; i++)
+    {
+        text += "0459"[rng() % 4];
+    }
+    return rng() % 4 == 0 ? "-" + text : text;
+}
+
+// The same number as text the parsers must also accept: leading zeros,
+// separators and whitespace among the digits, and sometimes whitespace or
+// '+' in front of the sign, which makes the '-' just another ignored character
+static string decorate(mt19937_64 &rng, const string &number)
+{
+    static const char noise[] = " \t\r\n,_+-";
+    string text;
+    size_t start = 0;
+    if (!number.empty() && number[0] == '-')
+    {
+        if (rng() % 4 == 0)
+            text += noise[rng() % 7];
+        text += '-';
+        start = 1;
+    }
+    text += string(rng() % 3, '0');
+    for (size_t i = start; i < number.size(); i++)
+    {
+        if (rng() % 4 == 0)
+            text += noise[rng() % (sizeof noise - 1)];
+        text += number[i];
+    }
+    if (rng() % 2)
+        text += noise[rng() % 4];
+    return text;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long long iterations = 500, seed = 1;
+    size_t maxDigits = 300;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc)
+            iterations = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--seed" && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--max-digits" && i + 1 < argc)
+            maxDigits = max<size_t>(1, strtoul(argv[++i], nullptr, 10));
+        else
+        {
+            cerr << "Usage: " << argv[0] << " [--iterations N] [--seed S] [--max-digits D]" << endl;
+            return 2;
+        }
+    }
+
+    mt19937_64 rng(seed);
+    const BigNumTuning defaults = BigNum::tuning();
+    BigNumTuning recursive = defaults;
+    recursive.karatsubaThreshold = 4;
+
+    for (unsigned long long n = 0; n < iterations; n++)
+    {
+        BigNum::setTuning(n % 2 ? recursive : defaults);
+        string a = makeNumber(rng, pickSize(rng, maxDigits));
+        string b = makeNumber(rng, pickSize(rng, maxDigits));
+        // Half the moduli are small enough for powMod and modInverse to be checked
+        size_t modulusDigits = rng() % 2 ? 1 + rng() % MAX_SMALL_MODULUS_DIGITS : pickSize(rng, maxDigits);
+        string m = makeNumber(rng, modulusDigits);
+        string e = makeNumber(rng, 1 + rng() % 30);
+
+        vector<uint8_t> bytes(rng() % 64);
+        for (uint8_t &byte : bytes)
+        {
+            byte = (uint8_t)rng();
+        }
+
+        try
+        {
+            BigNumDifferential::checkArithmetic(a, b, m, e);
+            BigNumDifferential::checkBytes(bytes.data(), bytes.size());
+            string decorated = decorate(rng, a);
+            vector<size_t> cuts(rng() % 6);
+            for (size_t &cut : cuts)
+            {
+                cut = rng() % (decorated.size() + 1);
+            }
+            sort(cuts.begin(), cuts.end());
+            BigNumDifferential::checkParser(decorated, cuts);
+            if (n == 0)
+                BigNumDifferential::checkX25519Vectors();
+            BigNumDifferential::checkField25519(makeNumber(rng, 1 + rng() % 90), makeNumber(rng, 1 + rng() % 90));
+            string den1 = makeNumber(rng, 1 + rng() % 40), den2 = makeNumber(rng, 1 + rng() % 40);
+            BigNumDifferential::checkRational(makeNumber(rng, 1 + rng() % 40), den1 == "0" ? "7" : den1,
+                                              makeNumber(rng, 1 + rng() % 40), den2 == "0" ? "12" : den2);
+            BigNumDifferential::checkFloat(makeFloatNumber(rng, pickSize(rng, 150)), (int64_t)(rng() % 61) - 30,
+                                           makeFloatNumber(rng, pickSize(rng, 150)), (int64_t)(rng() % 61) - 30,
+                                           1 + rng() % (rng() % 2 ? 600 : 60));
+            BigNumDifferential::checkSeries((long long)(rng() % 2001) - 1000, (long long)(rng() % 201) - 100,
+                                            1 + rng() % 1000, (long long)(rng() % 2001) - 1000, rng() % 1000,
+                                            1 + rng() % 200, (int)(rng() % 4));
+            if (n % 8 == 0)
+                BigNumDifferential::checkConstants(1 + rng() % 800, 1 + rng() % 300);
+            uint64_t count = rng() % 500;
+            BigNumDifferential::checkCombinatorics(count, rng() % (count + 2));
+            BigNumDifferential::checkBinomial(rng() >> (rng() % 64), rng() % 40);
+            if (n % 8 == 0)
+            {
+                // Odd and even total digit counts, so the index lands on both alignments
+                vector<string> values(rng() % 4, a);
+                for (string &value : values)
+                {
+                    value = makeNumber(rng, pickSize(rng, 40));
+                }
+                BigNumDifferential::checkArchive(values, "stress-" + to_string(seed) + ".bna");
+
+                int radix = 2 + rng() % 35;
+                string radixDigits(1 + rng() % 80, '0');
+                for (char &c : radixDigits)
+                {
+                    c = "0123456789abcdefghijklmnopqrstuvwxyz"[rng() % radix];
+                    if (rng() % 2)
+                        c = toupper(c);
+                }
+                BigNumDifferential::checkFiles(makeNumber(rng, pickSize(rng, 200)), radix, radixDigits,
+                                               "stress-" + to_string(seed) + ".txt");
+            }
+            if (n % 64 == 0)
+            {
+                string large(((size_t)1 << 16) + 1 + rng() % (1 << 16), '0');
+                large[0] = '1' + rng() % 9;
+                for (size_t i = 1; i < large.size(); i++)
+                {
+                    large[i] = '0' + rng() % 10;
+                }
+                BigNumDifferential::checkLargeFile(large, "stress-" + to_string(seed) + ".txt");
+            }
+        }
+        catch (const exception &ex)
+        {
+            cerr << "Iteration " << n << " (seed " << seed << ", karatsuba threshold "
+                 << BigNum::tuning().karatsubaThreshold << "): " << ex.what() << endl;
+            return 1;
+        }
+    }
+
+    BigNum::setTuning(defaults);
+    cout << iterations << " iterations passed (seed " << seed << ")" << endl;
+    return 0;
+}
@@ -0,0 +1,1248 @@
+#ifndef BIGNUM_HPP
+#define BIGNUM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define BIGNUM_HAVE_STRING_VIEW 1
+#include <string_view>
+#else
+#define BIGNUM_HAVE_STRING_VIEW 0
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BIGNUM_HAVE_MMAP 1
+#else
+#define BIGNUM_HAVE_MMAP 0
+#endif
+
+// Symbols of the public API. Define BIGNUM_STATIC when linking the static
+// library on Windows; BIGNUM_BUILDING is set while compiling the library.
+#if defined(_WIN32) || defined(__CYGWIN__)
+#if defined(BIGNUM_STATIC)
+#define BIGNUM_API
+#elif defined(BIGNUM_BUILDING)
+#define BIGNUM_API __declspec(dllexport)
+#else
+#define BIGNUM_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define BIGNUM_API __attribute__((visibility("default")))
+#else
+#define BIGNUM_API
+#endif
+
+/**
+ * MappedFile - a whole file mapped into memory
+ *
+ * Uses mmap on POSIX systems. Elsewhere the file is read into (or, for
+ * create(), written out from) an owned buffer, so callers see the same
+ * data()/size() interface either way.
+ */
+class BIGNUM_API MappedFile
+{
+private:
+    char *base;
+    std::size_t length;
+    bool writable;
+#if !BIGNUM_HAVE_MMAP
+    std::vector<char> buffer;
+    std::string writePath;
+#endif
+
+    MappedFile() : base(nullptr), length(0), writable(false) {}
+
+    void release();
+
+public:
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other);
+
+    ~MappedFile();
+
+    // Map an existing file read-only
+    static MappedFile openRead(const std::string &path);
+
+    // Create (or truncate) a file of exactly `size` bytes and map it writable
+    static MappedFile create(const std::string &path, std::size_t size);
+
+    const char *data() const { return base; }
+    char *data() { return base; }
+    std::size_t size() const { return length; }
+};
+
+/**
+ * BigNumTuning - algorithm crossover points used by BigNum's dispatch
+ *
+ * Starts from the defaults the library was compiled with. When the process
+ * starts using BigNum, a runtime config file named by the BIGNUM_TUNING
+ * environment variable (as written by BigNumTune --config) overrides them.
+ * The format is one "key = value" per line; '#' starts a comment and
+ * unknown keys are ignored so older builds accept newer files.
+ */
+struct BIGNUM_API BigNumTuning
+{
+    std::size_t karatsubaThreshold; // Digits; shorter operands use schoolbook multiplication
+
+    // Compile-time defaults (BIGNUM_KARATSUBA_THRESHOLD, BIGNUM_TUNING_HEADER)
+    BigNumTuning();
+
+    // Apply the settings from a config file on top of the current values
+    void load(const std::string &path);
+
+    void save(const std::string &path) const;
+
+    // Compile-time defaults, overridden by $BIGNUM_TUNING when it is set
+    static BigNumTuning fromEnvironment();
+};
+
+/**
+ * Hot-path statistics (build the library with -DBIGNUM_STATS to enable)
+ *
+ * Each instrumented primitive records calls, limbs (digits) processed, heap
+ * allocations, bytes allocated and cumulative cycles. Cycles are inclusive
+ * of nested primitives (a mulMod includes its multiply and reduction);
+ * allocations are charged to the innermost primitive only. Counters live in
+ * thread-local blocks that only their own thread writes, and are summed on
+ * demand by BigNum::stats(). Without BIGNUM_STATS the instrumentation
+ * compiles away and stats() reports enabled == false.
+ */
+enum BigNumStat
+{
+    STAT_MUL_SCHOOLBOOK,
+    STAT_MUL_KARATSUBA,
+    STAT_DIVMOD,
+    STAT_REDUCE_DIVISION,
+    STAT_REDUCE_CONTEXT,
+    STAT_ADDMOD,
+    STAT_MULMOD,
+    STAT_POWMOD_WINDOW1,
+    STAT_MODINVERSE,
+    STAT_POWMOD_CONSTTIME,
+    STAT_POWMOD_LADDER,
+    STAT_OTHER, // allocations outside any instrumented primitive
+    STAT_COUNT
+};
+
+struct BigNumStatRecord
+{
+    std::uint64_t calls, limbs, allocations, bytes, cycles;
+};
+
+struct BIGNUM_API BigNumStats
+{
+    bool enabled;
+    BigNumStatRecord records[STAT_COUNT];
+
+    BigNumStats();
+
+    static const char *name(int stat);
+
+    void dump(std::ostream &os) const;
+};
+
+// Heap traffic of BigNum storage on one thread
+struct BigNumAllocationCount
+{
+    std::uint64_t allocations, bytes;
+};
+
+// Observer called on every digit allocation (after it is counted)
+typedef void (*BigNumAllocationHook)(std::size_t bytes);
+
+// Per-thread counting of digit allocations, forwarded to the installed hook
+class BIGNUM_API BigNumAllocationTracker
+{
+public:
+    static std::atomic<BigNumAllocationHook> &hook();
+
+    static BigNumAllocationCount local();
+
+    static void record(std::size_t bytes);
+};
+
+// Makes any BigNum allocation on this thread throw while in scope
+class BIGNUM_API BigNumNoAllocationScope
+{
+public:
+    BigNumNoAllocationScope();
+    ~BigNumNoAllocationScope();
+
+    BigNumNoAllocationScope(const BigNumNoAllocationScope &) = delete;
+    BigNumNoAllocationScope &operator=(const BigNumNoAllocationScope &) = delete;
+};
+
+// Block reuse by the limb pools of one thread
+struct BigNumLimbPoolStats
+{
+    std::uint64_t hits;        // served from a free list
+    std::uint64_t misses;      // taken from the global heap
+    std::uint64_t remoteFrees; // blocks this thread handed back to another thread's pool
+    std::size_t retainedBytes; // held in free lists right now
+};
+
+/**
+ * BigNumLimbPool - per-thread, size-class free lists behind LimbAllocator
+ *
+ * Requests up to MAX_BLOCK bytes are rounded up to a power of two from
+ * MIN_BLOCK and served from the calling thread's free list for that class,
+ * so steady-state arithmetic on many threads never touches the global heap
+ * or takes a lock. Each block records the pool it came from. A block freed
+ * on another thread is pushed onto its owner's lock-free return stack, and
+ * the owner takes the whole stack back when a free list runs dry. When a
+ * thread exits, its cached blocks go back to the heap and the pool is
+ * parked for the next new thread; blocks still returned to a parked pool
+ * wait for that thread or for trim(). A thread keeps at most retainLimit()
+ * bytes cached and frees the rest immediately. Larger requests go straight
+ * to the heap. Building with BIGNUM_NO_POOL (or a sanitizer) turns pooling
+ * off.
+ */
+class BIGNUM_API BigNumLimbPool
+{
+public:
+    static const std::size_t MIN_BLOCK = 64;
+    static const std::size_t MAX_BLOCK = 32768;
+    static const std::size_t DEFAULT_RETAIN_LIMIT = 4u << 20; // per thread
+
+    static void *allocate(std::size_t bytes);
+    static void deallocate(void *p, std::size_t bytes) noexcept;
+
+    // Cap on the bytes each thread keeps cached; applies from the next free
+    static void setRetainLimit(std::size_t bytes);
+    static std::size_t retainLimit();
+
+    // Return this thread's cached blocks, and those handed back to exited
+    // threads, to the heap; yields the number of bytes released
+    static std::size_t trim();
+
+    static BigNumLimbPoolStats local();
+};
+
+// Allocator for digit storage; the single place BigNum obtains heap memory
+template <typename T>
+struct LimbAllocator
+{
+    typedef T value_type;
+
+    LimbAllocator() noexcept {}
+    template <typename U>
+    LimbAllocator(const LimbAllocator<U> &) noexcept {}
+
+    T *allocate(std::size_t n)
+    {
+        BigNumAllocationTracker::record(n * sizeof(T));
+        return static_cast<T *>(BigNumLimbPool::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, std::size_t n) noexcept
+    {
+        BigNumLimbPool::deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const LimbAllocator<U> &) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const LimbAllocator<U> &) const noexcept { return false; }
+};
+
+typedef std::vector<int, LimbAllocator<int>> DigitVector;
+
+// Thrown by an operation that noticed its stop token was triggered
+class BIGNUM_API BigNumCancelled : public std::runtime_error
+{
+public:
+    explicit BigNumCancelled(const char *what = "BigNum operation cancelled") : std::runtime_error(what) {}
+};
+
+// Thrown instead when the token's deadline passed
+class BIGNUM_API BigNumDeadlineExceeded : public BigNumCancelled
+{
+public:
+    BigNumDeadlineExceeded() : BigNumCancelled("BigNum operation exceeded its deadline") {}
+};
+
+/**
+ * BigNumStopToken - cooperative cancellation for long-running operations
+ *
+ * Obtained from a BigNumStopSource, given a deadline with withDeadline()
+ * or withTimeout(), or both. Operations that take a token check it between
+ * stages (per exponent bit in powMod, per Euclid step in modInverse, per
+ * Miller-Rabin round) and throw BigNumCancelled once a stop
+ * is requested, or BigNumDeadlineExceeded once the deadline has passed. A
+ * default-constructed token never stops and costs two flag tests per stage;
+ * only a token with a deadline reads the clock.
+ */
+class BIGNUM_API BigNumStopToken
+{
+private:
+    std::shared_ptr<const std::atomic<bool>> flag;
+    std::chrono::steady_clock::time_point deadline_;
+    bool timed;
+
+    friend class BigNumStopSource;
+
+public:
+    BigNumStopToken() : timed(false) {}
+
+    bool stopRequested() const
+    {
+        return (flag && flag->load(std::memory_order_relaxed)) ||
+               (timed && std::chrono::steady_clock::now() >= deadline_);
+    }
+
+    void throwIfStopped() const
+    {
+        if (flag && flag->load(std::memory_order_relaxed))
+            throw BigNumCancelled();
+        if (timed && std::chrono::steady_clock::now() >= deadline_)
+            throw BigNumDeadlineExceeded();
+    }
+
+    // This token, also stopping at deadline (the earlier deadline wins)
+    BigNumStopToken withDeadline(std::chrono::steady_clock::time_point deadline) const
+    {
+        BigNumStopToken token(*this);
+        if (!timed || deadline < deadline_)
+            token.deadline_ = deadline;
+        token.timed = true;
+        return token;
+    }
+
+    BigNumStopToken withTimeout(std::chrono::steady_clock::duration budget) const
+    {
+        return withDeadline(std::chrono::steady_clock::now() + budget);
+    }
+};
+
+class BIGNUM_API BigNumStopSource
+{
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+
+public:
+    BigNumStopSource() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    BigNumStopToken token() const
+    {
+        BigNumStopToken token;
+        token.flag = flag;
+        return token;
+    }
+
+    void requestStop() { flag->store(true, std::memory_order_relaxed); }
+
+    bool stopRequested() const { return flag->load(std::memory_order_relaxed); }
+};
+
+// Called between stages with the fraction of the work done, in [0, 1]
+typedef std::function<void(double)> BigNumProgress;
+
+/**
+ * BigNum Library Implementation
+ *
+ * Assignment: Public Key Cryptosystems BigNum Library
+ * Requirements:
+ * - Support for very large integers (512, 1024, 2048+ bits)
+ * - Number representation
+ * - Modulo integer operations: addition, multiplication, and inversion
+ */
+
+class BigNumView;
+
+class BIGNUM_API BigNum
+{
+private:
+    DigitVector digits; // Store digits in reverse order (least significant first)
+    bool is_negative;
+
+    friend class Field25519;
+    friend class BigNumView;
+    friend class BigNumArchive;
+    friend class BigNumParser;
+    friend class BigNumModContext;
+    friend class BigNumModContextCache;
+    friend class BigNumMontgomery;
+    friend class BigNumRpc;
+    friend class BigRational;
+    friend class BigFloat;
+    friend class BigNumSeries;
+
+    // Helper function to remove leading zeros
+    void removeLeadingZeros();
+
+    // The magnitude as a digit span. A move leaves digits empty rather than
+    // allocate, and an empty magnitude reads as the single digit 0.
+    static constexpr int zeroDigit = 0;
+    const int *digitData() const { return digits.empty() ? &zeroDigit : digits.data(); }
+    std::size_t digitCount() const { return digits.empty() ? 1 : digits.size(); }
+
+    // No digits yet, room for the given count: for results filled in place
+    struct Capacity
+    {
+        std::size_t digits;
+    };
+    explicit BigNum(Capacity capacity) : is_negative(false) { digits.reserve(capacity.digits); }
+
+    // Parse text: a leading '-' makes the number negative, non-digits are ignored
+    template <typename InputIt>
+    void assignText(InputIt first, InputIt last)
+    {
+        digits.clear();
+        is_negative = false;
+        if (first != last && *first == '-')
+        {
+            is_negative = true;
+            ++first;
+        }
+
+        for (; first != last; ++first)
+        {
+            char c = *first;
+            if (c >= '0' && c <= '9')
+            {
+                digits.push_back(c - '0');
+            }
+        }
+        std::reverse(digits.begin(), digits.end());
+
+        if (digits.empty())
+        {
+            digits.push_back(0);
+            is_negative = false;
+        }
+
+        removeLeadingZeros();
+        if (isZero())
+            is_negative = false;
+    }
+
+    // Compare magnitudes of two digit spans: -1, 0 or 1
+    static int compareMagnitude(const int *a, std::size_t na, const int *b, std::size_t nb);
+
+    // r = a + b, or a - b if negateB: one magnitude compare and one add or
+    // subtract pass. r may be a or b; it allocates only if r must grow past
+    // its capacity.
+    static void addSigned(BigNum &r, const BigNum &a, const BigNum &b, bool negateB);
+
+    static BigNumTuning &tuningStorage();
+
+    // Schoolbook product of two digit spans (result has na + nb digits)
+    static DigitVector mulSchoolbook(const int *a, std::size_t na, const int *b, std::size_t nb);
+
+    // r[offset ...] += p; r must be long enough to absorb the final carry
+    static void addShifted(DigitVector &r, std::size_t offset, const int *p, std::size_t np);
+
+    // r -= p, where r >= p
+    static void subInPlace(DigitVector &r, const DigitVector &p);
+
+    static void trimZeros(DigitVector &d);
+
+    // Karatsuba: (a1 X + a0)(b1 X + b0) with three half-size products
+    static DigitVector mulKaratsuba(const int *a, std::size_t na, const int *b, std::size_t nb);
+
+    // Product of two digit spans (result has na + nb digits), dispatched on size
+    static DigitVector mulMagnitude(const int *a, std::size_t na, const int *b, std::size_t nb);
+
+    // Short product: a lower bound on a * b (na + nb digits) that keeps every
+    // a[i] b[j] with i + j >= skip and may drop the rest, so the full product
+    // exceeds it by less than 9 * skip * 10^skip. Schoolbook sizes skip the
+    // low columns; larger ones split Mulders-style into a full product of the
+    // top 70% or so and two short cross products.
+    static DigitVector mulShort(const int *a, std::size_t na, const int *b, std::size_t nb, std::size_t skip);
+
+    // Big-endian bytes of a digit span's magnitude (empty for zero). Digits are
+    // regrouped into base-10^9 words, which are then divided by 2^32 per pass.
+    static std::vector<std::uint8_t> toBytesMagnitude(const int *d, std::size_t n);
+
+    // Value of a digit character in radix 2..36, or -1 if it is not a digit
+    static int digitValue(char c);
+
+    static void checkRadix(int radix);
+
+    // Number of radix digits whose value always fits in a long long
+    static int chunkDigits(int radix, long long *power = nullptr);
+
+    // Magnitude of a value known to be below 2^63
+    long long toLongLong() const;
+
+    // Run body(from, to) over [0, n) split across the hardware threads
+    template <typename Body>
+    static void parallelFor(std::size_t n, std::size_t minChunk, Body body);
+
+    // Number of recursion levels worth forking for divide-and-conquer conversion
+    static int parallelDepth();
+
+    // Divide-and-conquer radix parser: value = high * radix^(chunk * 2^k) + low,
+    // where powers[k] = radix^(chunk * 2^k)
+    static BigNum parseRadix(const char *p, std::size_t len, int radix, int chunk,
+                             const std::vector<BigNum> &powers, int depth);
+
+    // Divide-and-conquer radix printer for 0 <= value < powers[level],
+    // left-padded with zeros to `pad` characters
+    static std::string emitRadix(const BigNum &value, int level, std::size_t pad, int radix, int chunk,
+                                 const std::vector<BigNum> &powers, int depth);
+
+public:
+    // Merged hot-path counters from all threads (see BIGNUM_STATS)
+    static BigNumStats stats();
+
+    static void resetStats();
+
+    static void dumpStats(std::ostream &os = std::cerr);
+
+    // Current algorithm crossover points
+    static const BigNumTuning &tuning();
+
+    // Replace the crossover points (not synchronized: call before starting threads)
+    static void setTuning(const BigNumTuning &settings);
+
+    // Digit allocations made by the calling thread so far
+    static BigNumAllocationCount threadAllocations();
+
+    // Install an observer for every digit allocation; returns the previous one
+    static BigNumAllocationHook setAllocationHook(BigNumAllocationHook hook);
+
+    // Default constructor - creates zero
+    BigNum();
+
+    // Constructor from string
+    BigNum(const std::string &str);
+
+    // Constructor from a C string (a template so that BigNum(0) stays an integer)
+    template <typename CharPtr,
+              typename = typename std::enable_if<std::is_same<CharPtr, const char *>::value ||
+                                                 std::is_same<CharPtr, char *>::value>::type>
+    BigNum(CharPtr str) : is_negative(false)
+    {
+        assignText(str, str + std::strlen(str));
+    }
+
+#if BIGNUM_HAVE_STRING_VIEW
+    // Constructor from string_view (no intermediate std::string)
+    BigNum(std::string_view str);
+#endif
+
+    // Constructor from a range of characters
+    template <typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+    BigNum(InputIt first, InputIt last) : is_negative(false)
+    {
+        assignText(first, last);
+    }
+
+    // Constructor from integer
+    BigNum(long long num);
+
+    // Copy constructor
+    BigNum(const BigNum &other) : digits(other.digits), is_negative(other.is_negative) {}
+
+    // Move constructor; other is left as zero without allocating (no digits)
+    BigNum(BigNum &&other) noexcept : digits(std::move(other.digits)), is_negative(other.is_negative)
+    {
+        other.digits.clear();
+        other.is_negative = false;
+    }
+
+    // Assignment operator
+    BigNum &operator=(const BigNum &other);
+
+    // Move assignment; swaps storage, so other keeps a valid value
+    BigNum &operator=(BigNum &&other) noexcept
+    {
+        digits.swap(other.digits);
+        std::swap(is_negative, other.is_negative);
+        return *this;
+    }
+
+    // Check if number is zero
+    bool isZero() const
+    {
+        return digits.empty() || (digits.size() == 1 && digits[0] == 0);
+    }
+
+    // Check if number is one
+    bool isOne() const
+    {
+        return !is_negative && digits.size() == 1 && digits[0] == 1;
+    }
+
+    // Comparison operators
+    bool operator==(const BigNum &other) const;
+
+    bool operator!=(const BigNum &other) const
+    {
+        return !(*this == other);
+    }
+
+    bool operator<(const BigNum &other) const;
+
+    bool operator<=(const BigNum &other) const
+    {
+        return !(other < *this);
+    }
+
+    bool operator>(const BigNum &other) const
+    {
+        return other < *this;
+    }
+
+    bool operator>=(const BigNum &other) const
+    {
+        return !(*this < other);
+    }
+
+    // Unary minus
+    BigNum operator-() const;
+
+    // Addition
+    BigNum operator+(const BigNum &other) const;
+
+    // In-place addition; allocates nothing when capacity() covers the result
+    BigNum &operator+=(const BigNum &other);
+
+    // Make room for a magnitude of the given number of digits without reallocating
+    void reserve(std::size_t digitCount)
+    {
+        digits.reserve(digitCount);
+    }
+
+    std::size_t capacity() const
+    {
+        return digits.capacity();
+    }
+
+    // Subtraction
+    BigNum operator-(const BigNum &other) const;
+
+    // In-place subtraction; allocates nothing when capacity() covers the result
+    BigNum &operator-=(const BigNum &other);
+
+    // Multiplication
+    BigNum operator*(const BigNum &other) const;
+
+    // Division (integer division)
+    BigNum operator/(const BigNum &divisor) const;
+
+    // Modulo operation
+    BigNum operator%(const BigNum &divisor) const;
+
+    // Modular addition: (a + b) mod m (through the shared context cache)
+    BigNum addMod(const BigNum &b, const BigNum &m) const;
+
+    // Modular multiplication: (a * b) mod m (through the shared context cache)
+    BigNum mulMod(const BigNum &b, const BigNum &m) const;
+
+    // Modular multiplication on views, e.g. operands read from a BigNumArchive
+    static BigNum mulMod(const BigNumView &a, const BigNumView &b, const BigNum &m);
+
+    // Fast modular exponentiation: (base^exp) mod m
+    BigNum powMod(const BigNum &exp, const BigNum &m) const;
+    BigNum powMod(const BigNum &exp, const BigNum &m, const BigNumStopToken &stop) const;
+
+    // (base^exp) mod m without secret-dependent branches or memory accesses
+    // (see BigNumMontgomery); m must be odd
+    BigNum powModConstTime(const BigNum &exp, const BigNum &m) const;
+    BigNum powModLadder(const BigNum &exp, const BigNum &m) const;
+
+    // Greatest common divisor of |a| and |b| (0 only if both are 0)
+    static BigNum gcd(const BigNum &a, const BigNum &b);
+
+    // Extended Euclidean Algorithm
+    static BigNum extendedGCD(const BigNum &a, const BigNum &b, BigNum &x, BigNum &y);
+
+    // Modular inverse: find x such that (a * x) ≡ 1 (mod m)
+    BigNum modInverse(const BigNum &m) const;
+    BigNum modInverse(const BigNum &m, const BigNumStopToken &stop) const;
+
+    /**
+     * Miller-Rabin test: false means composite; true means prime with
+     * error probability at most 4^-rounds. Bases are the first primes, then
+     * fixed pseudo-random values, so the answer is reproducible. Checks stop
+     * and reports progress after every round.
+     */
+    bool isProbablePrime(int rounds = 25) const;
+    bool isProbablePrime(int rounds, const BigNumStopToken &stop,
+                         const BigNumProgress &progress = BigNumProgress()) const;
+
+    /**
+     * Combinatorial functions, built from prime factorizations: primes come
+     * from a segmented sieve and each product is a balanced tree over
+     * word-sized factors, so the multiplications pair operands of similar
+     * size. factorial uses the prime swing, n! = ((n/2)!)^2 * swing(n).
+     */
+    static BigNum factorial(std::uint64_t n);
+
+    // n! / (k! (n - k)!); 0 if k > n
+    static BigNum binomial(std::uint64_t n, std::uint64_t k);
+
+    // Product of the primes up to n
+    static BigNum primorial(std::uint64_t n);
+
+    // n (n - 2) (n - 4) ... down to 2 or 1; 1 for n = 0
+    static BigNum doubleFactorial(std::uint64_t n);
+
+    // Get bit length of the number
+    int getBitLength() const;
+
+    // Convert to string
+    std::string toString() const;
+
+    /**
+     * Parse a number from a text file in the given radix (2..36) without an
+     * intermediate string: the file is memory-mapped and decimal digits are
+     * copied straight from the mapping in parallel chunks; other radixes use
+     * the divide-and-conquer converter. Surrounding whitespace and a leading
+     * sign are accepted; any other non-digit character is an error.
+     */
+    static BigNum fromFile(const std::string &path, int radix = 10);
+
+    /**
+     * Write the number as text in the given radix (2..36), followed by a
+     * newline. The file is preallocated at its final size and filled through
+     * a writable mapping.
+     */
+    void toFile(const std::string &path, int radix = 10) const;
+
+    // Big-endian bytes of the magnitude (empty for zero); the sign is not encoded
+    std::vector<std::uint8_t> toBytes() const;
+
+    // Non-negative number from big-endian bytes
+    static BigNum fromBytes(const std::uint8_t *data, std::size_t len);
+
+    // Print the number
+    void print() const;
+
+    // Input operator (streams the token through a BigNumParser)
+    friend std::istream &operator>>(std::istream &is, BigNum &num);
+
+    // Output operator
+    friend std::ostream &operator<<(std::ostream &os, const BigNum &num);
+};
+
+BIGNUM_API std::istream &operator>>(std::istream &is, BigNum &num);
+BIGNUM_API std::ostream &operator<<(std::ostream &os, const BigNum &num);
+
+/**
+ * BigNumModContext - precomputed state for repeated arithmetic modulo m
+ *
+ * Holds |m| and its multiples 0 .. 9 |m|, so reducing a product is a single
+ * pass of long division that picks each quotient digit from the table and
+ * subtracts it in place, instead of the repeated BigNum subtraction of
+ * operator%. Results are in [0, |m|), as for BigNum's own addMod, mulMod
+ * and powMod. A context is immutable after construction and may be shared
+ * between threads.
+ */
+class BIGNUM_API BigNumModContext
+{
+private:
+    BigNum modulus_;                   // |m|
+    std::vector<DigitVector> multiples; // multiples[q] = q * |m|, trimmed
+
+    // Largest q <= 9 with q |m| <= rem (n trimmed digits)
+    int quotientDigit(const int *rem, std::size_t n) const;
+
+    // rem = x mod |m| for the magnitude x (trimmed, at least one digit);
+    // also the quotient's magnitude when one is asked for
+    void reduceMagnitude(const int *x, std::size_t n, DigitVector &rem, DigitVector *quotient = nullptr) const;
+
+    // Reduced magnitude with the sign of the unreduced value applied
+    BigNum finish(DigitVector &rem, bool negative) const;
+
+public:
+    // Throws runtime_error if m is zero
+    explicit BigNumModContext(const BigNum &m);
+
+    // |m|
+    const BigNum &modulus() const { return modulus_; }
+
+    // Bytes needed for any reduced value in BigNum::toBytes form
+    std::size_t byteLength() const;
+
+    // x mod m
+    BigNum reduce(const BigNum &x) const;
+
+    // x / |m|, truncated toward zero like BigNum's operator/
+    BigNum divide(const BigNum &x) const;
+
+    // (a + b) mod m
+    BigNum addMod(const BigNum &a, const BigNum &b) const;
+
+    // (a * b) mod m; takes BigNums as well as views
+    BigNum mulMod(const BigNumView &a, const BigNumView &b) const;
+
+    // out = (a * b) mod m, with the schoolbook product and its reduction
+    // both done in out's storage. Allocates nothing when out has capacity
+    // for a.size() + b.size() digits and is neither operand; otherwise it
+    // falls back to the form above.
+    void mulMod(const BigNumView &a, const BigNumView &b, BigNum &out) const;
+
+    // (base^|exp|) mod m
+    BigNum powMod(const BigNum &base, const BigNum &exp) const;
+
+    // As above, checking stop per exponent bit and reporting progress per byte
+    BigNum powMod(const BigNum &base, const BigNum &exp, const BigNumStopToken &stop,
+                  const BigNumProgress &progress = BigNumProgress()) const;
+
+    // results[i] = bases[i]^|exps[i]| mod m, spread across the hardware threads
+    void powModBatch(const BigNum *bases, const BigNum *exps, BigNum *results, std::size_t count) const;
+};
+
+/**
+ * BigNumMontgomery - constant-time exponentiation modulo an odd m
+ *
+ * Holds |m| as binary limbs with the Montgomery constants R^2 mod m and
+ * -m^-1 mod 2^LIMB_BITS, where R = 2^(LIMB_BITS * limbs). Products are
+ * formed by word-by-word Montgomery reduction with a masked final
+ * subtraction, so no branch or memory access depends on operand values.
+ *
+ * powModConstTime() scans the exponent in fixed WINDOW_BITS windows. Its
+ * table of base powers is stored interleaved (limb i of every entry is
+ * adjacent), and each lookup reads all entries and keeps one by masking.
+ * powModLadder() runs the Montgomery ladder with mask-based swaps: one
+ * multiplication and one squaring per bit, and no table. The exponent and
+ * base are converted from decimal by a fixed multiply-by-10 pass over a
+ * width set by the modulus and the operand's digit count, with no trimming,
+ * so timing reveals only sizes: the modulus and the exponent's decimal
+ * length. A base that is negative or does not fit the modulus's limbs is
+ * first reduced by operator%, and the result is converted back to decimal
+ * by BigNum::fromBytes; neither step is constant-time. A context is
+ * immutable after construction and may be shared between threads.
+ */
+class BIGNUM_API BigNumMontgomery
+{
+private:
+#if defined(__SIZEOF_INT128__)
+    typedef std::uint64_t Limb;
+    typedef unsigned __int128 Wide;
+#else
+    typedef std::uint32_t Limb;
+    typedef std::uint64_t Wide;
+#endif
+    static const int LIMB_BITS = 8 * sizeof(Limb);
+    static const int WINDOW_BITS = 5;
+    static const int TABLE_SIZE = 1 << WINDOW_BITS;
+
+    BigNum modulus_;          // |m|
+    std::vector<Limb> limbs;  // |m|, least significant first
+    std::vector<Limb> rr;     // R^2 mod m
+    std::vector<Limb> unity;  // R mod m, i.e. 1 in Montgomery form
+    Limb inverse;             // -m^-1 mod 2^LIMB_BITS
+
+    // Magnitude of x as limbs, least significant first (at least one)
+    static std::vector<Limb> toLimbs(const BigNum &x);
+
+    // Magnitude of x as at least width limbs, untrimmed; the work and the
+    // limb count depend only on width and x's digit count
+    static std::vector<Limb> fixedLimbs(const BigNum &x, std::size_t width);
+
+    // r = a * b / R mod m for a < R, b < m; t holds limbs + 2 words, r may alias a or b
+    void multiply(Limb *r, const Limb *a, const Limb *b, Limb *t) const;
+
+    // base mod m in Montgomery form
+    std::vector<Limb> enter(const BigNum &base) const;
+
+    // Leave Montgomery form
+    BigNum leave(const Limb *x, Limb *t) const;
+
+public:
+    // Throws runtime_error if m is even (or zero)
+    explicit BigNumMontgomery(const BigNum &m);
+
+    const BigNum &modulus() const { return modulus_; }
+
+    // (base^|exp|) mod m, fixed-window with masked table lookups
+    BigNum powModConstTime(const BigNum &base, const BigNum &exp) const;
+
+    // (base^|exp|) mod m, Montgomery ladder
+    BigNum powModLadder(const BigNum &base, const BigNum &exp) const;
+};
+
+struct BigNumModCacheStats
+{
+    std::uint64_t hits, misses, evictions;
+    std::uint64_t bypassed; // moduli too long to retain
+    std::size_t entries, capacity;
+};
+
+/**
+ * BigNumModContextCache - bounded LRU of modulus contexts
+ *
+ * Maps a 64-bit fingerprint of |m| to its BigNumModContext, so that
+ * repeated addMod, mulMod and powMod calls with one modulus share a single
+ * precomputed table without the caller keeping a context around. A hit is
+ * confirmed against the modulus itself, so a fingerprint collision only
+ * costs a rebuild. Moduli longer than maxDigits are not retained, since
+ * building their context is cheap next to one multiplication at that size.
+ * Every member is thread-safe, and a returned context stays valid for as
+ * long as the caller holds it, even after eviction.
+ *
+ * recent() puts a per-thread front on the LRU for the per-call paths
+ * (BigNum::addMod, mulMod and powMod). Each thread keeps its last few
+ * contexts and matches them by comparing digits, so a repeated modulus costs
+ * one O(k) compare, with no lock, hash, list update or reference count
+ * change. Only misses reach get() and count in stats().
+ */
+class BIGNUM_API BigNumModContextCache
+{
+private:
+    struct Entry
+    {
+        std::uint64_t fingerprint;
+        std::shared_ptr<const BigNumModContext> context;
+    };
+
+    std::mutex lock;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index;
+    std::size_t capacity_, maxDigits_;
+    std::uint64_t hits, misses, evictions, bypassed;
+
+    static std::uint64_t fingerprint(const BigNum &m);
+
+    // Drop least recently used entries beyond capacity (lock held)
+    void trim();
+
+public:
+    static const std::size_t DEFAULT_CAPACITY = 64;
+    static const std::size_t DEFAULT_MAX_DIGITS = 4096;
+    static const std::size_t RECENT_PER_THREAD = 4;
+
+    explicit BigNumModContextCache(std::size_t capacity = DEFAULT_CAPACITY,
+                                   std::size_t maxDigits = DEFAULT_MAX_DIGITS);
+
+    // Context for m, built on a miss; throws runtime_error if m is zero
+    std::shared_ptr<const BigNumModContext> get(const BigNum &m);
+
+    // Context for m from this thread's recent ones, else from get(). The
+    // thread holds it until it has used RECENT_PER_THREAD other moduli, so
+    // use it before calling recent() again.
+    const BigNumModContext &recent(const BigNum &m);
+
+    void setCapacity(std::size_t capacity);
+
+    // Drop every entry (counters are kept)
+    void clear();
+
+    BigNumModCacheStats stats();
+
+    void resetStats();
+
+    // The cache behind BigNum::addMod, mulMod and powMod
+    static BigNumModContextCache &shared();
+};
+
+/**
+ * BigNumThreadPool - fixed set of worker threads fed from one FIFO queue
+ *
+ * Tasks start in submission order as workers become free. The destructor
+ * runs every task still queued before joining the workers. As with
+ * std::thread, a task that throws terminates the process, so tasks report
+ * their own errors.
+ */
+class BIGNUM_API BigNumThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable ready;
+    bool stopping;
+
+    void work();
+
+public:
+    // threads == 0 starts one worker per hardware thread
+    explicit BigNumThreadPool(std::size_t threads = 0);
+    ~BigNumThreadPool();
+
+    BigNumThreadPool(const BigNumThreadPool &) = delete;
+    BigNumThreadPool &operator=(const BigNumThreadPool &) = delete;
+
+    std::size_t size() const { return workers.size(); }
+
+    void submit(std::function<void()> task);
+
+    // Tasks queued and not yet started
+    std::size_t pending();
+
+    // Process-wide pool, one worker per hardware thread, started on first use
+    static BigNumThreadPool &shared();
+};
+
+/**
+ * BigNumParser - incremental decimal parser
+ *
+ * Accepts the text of one number in chunks as they arrive (from a socket,
+ * a pipe or a file read loop) and produces the BigNum with finish(). Each
+ * digit goes straight into the result's digit storage, so no copy of the
+ * whole text is ever held. The syntax matches BigNum(const string &): a
+ * '-' as the very first character makes the number negative and any other
+ * non-digit character is ignored.
+ */
+class BIGNUM_API BigNumParser
+{
+private:
+    DigitVector pending; // Digits received so far, most significant first
+    bool negative;
+    bool started;
+
+public:
+    BigNumParser() : negative(false), started(false) {}
+
+    void feed(char c);
+
+    void feed(const char *data, std::size_t len);
+
+#if BIGNUM_HAVE_STRING_VIEW
+    void feed(std::string_view chunk);
+#endif
+
+    // Number of digits received so far
+    std::size_t digitCount() const;
+
+    // Produce the parsed number and reset the parser for the next one
+    BigNum finish();
+};
+
+/**
+ * BigNumView - read-only view of a BigNum's digits held elsewhere
+ *
+ * A view does not own its digits; it points either into a BigNum or into a
+ * memory-mapped BigNumArchive, so it must not outlive that storage. Views
+ * support the read-only operations (comparison, toBytes, toString) and can
+ * be passed as operands to BigNum::mulMod without being copied.
+ */
+class BIGNUM_API BigNumView
+{
+private:
+    const int *limbs;
+    std::size_t length;
+    bool negative;
+
+public:
+    BigNumView(const int *digits, std::size_t count, bool is_negative)
+        : limbs(digits), length(count), negative(is_negative) {}
+
+    // Implicit view of an existing BigNum
+    BigNumView(const BigNum &num)
+        : limbs(num.digitData()), length(num.digitCount()), negative(num.is_negative) {}
+
+    std::size_t size() const { return length; }
+    const int *data() const { return limbs; }
+    bool isNegative() const { return negative; }
+    bool isZero() const { return length == 1 && limbs[0] == 0; }
+
+    // Three-way comparison: -1, 0 or 1
+    int compare(const BigNumView &other) const;
+
+    friend bool operator==(const BigNumView &a, const BigNumView &b) { return a.compare(b) == 0; }
+    friend bool operator!=(const BigNumView &a, const BigNumView &b) { return a.compare(b) != 0; }
+    friend bool operator<(const BigNumView &a, const BigNumView &b) { return a.compare(b) < 0; }
+    friend bool operator<=(const BigNumView &a, const BigNumView &b) { return a.compare(b) <= 0; }
+    friend bool operator>(const BigNumView &a, const BigNumView &b) { return a.compare(b) > 0; }
+    friend bool operator>=(const BigNumView &a, const BigNumView &b) { return a.compare(b) >= 0; }
+
+    std::vector<std::uint8_t> toBytes() const;
+
+    // Copy the digits into an owning BigNum
+    BigNum toBigNum() const;
+
+    std::string toString() const;
+
+    friend std::ostream &operator<<(std::ostream &os, const BigNumView &view);
+};
+
+BIGNUM_API std::ostream &operator<<(std::ostream &os, const BigNumView &view);
+
+/**
+ * BigNumArchive - compact binary container for arrays of BigNums
+ *
+ * Layout (host byte order, little-endian in practice):
+ *   header:  char magic[4] = "BNA1", uint32 version, uint64 count,
+ *            uint64 indexOffset, uint64 reserved              (32 bytes)
+ *   entries: uint32 flags (bit 0 = negative), uint32 length,
+ *            int32 digits[length], least significant first
+ *   index:   uint64 offsets[count], byte offset of each entry, starting
+ *            at the first multiple of 8 after the entries
+ *
+ * Entries store the in-memory digit layout, so open() only maps the file
+ * and checks the header; each operator[] checks its entry's digits and
+ * returns a BigNumView pointing straight into the mapping.
+ */
+class BIGNUM_API BigNumArchive
+{
+private:
+    static const std::uint32_t VERSION = 1;
+    static const std::size_t HEADER_SIZE = 32;
+
+    MappedFile file;
+    const std::uint64_t *offsets;
+    std::size_t count;
+
+    explicit BigNumArchive(MappedFile &&mapped) : file(std::move(mapped)), offsets(nullptr), count(0) {}
+
+    static void corrupt(const std::string &what);
+
+public:
+    // Write all values to a new archive at path
+    static void write(const std::string &path, const std::vector<BigNum> &values);
+
+    // Map an archive for reading; cost is independent of the number of entries
+    static BigNumArchive open(const std::string &path);
+
+    std::size_t size() const { return count; }
+
+    // Zero-copy view of entry i (valid while the archive is open)
+    BigNumView operator[](std::size_t i) const;
+};
+
+/**
+ * Field25519 - arithmetic in GF(2^255 - 19) for Curve25519 / X25519
+ *
+ * Elements are held as five 51-bit limbs (radix 2^51). Addition leaves
+ * carries unpropagated and subtraction only carries its subtrahend, so a
+ * ladder step spends its time in the ten multiplications/squarings, each of
+ * which folds the high half back with the factor 19 and carries once.
+ * Only toBytes() and toBigNum() produce the canonical representative.
+ *
+ * x25519() runs the RFC 7748 Montgomery ladder with a fixed sequence of
+ * field operations and mask-based conditional swaps, independent of the
+ * scalar bits.
+ */
+class BIGNUM_API Field25519
+{
+private:
+    static const std::uint64_t MASK51 = (1ULL << 51) - 1;
+
+#if defined(__SIZEOF_INT128__)
+    typedef unsigned __int128 Wide;
+
+    static Wide wideMul(std::uint64_t a, std::uint64_t b) { return (Wide)a * b; }
+    static std::uint64_t wideLow51(const Wide &w) { return (std::uint64_t)w & MASK51; }
+    static std::uint64_t wideShift51(const Wide &w) { return (std::uint64_t)(w >> 51); }
+#else
+    // Portable 128-bit accumulator for compilers without __int128
+    struct Wide
+    {
+        std::uint64_t lo, hi;
+
+        Wide(std::uint64_t v = 0) : lo(v), hi(0) {}
+
+        Wide &operator+=(const Wide &other)
+        {
+            std::uint64_t sum = lo + other.lo;
+            hi += other.hi + (sum < lo);
+            lo = sum;
+            return *this;
+        }
+    };
+
+    static Wide wideMul(std::uint64_t a, std::uint64_t b)
+    {
+        std::uint64_t a_lo = a & 0xFFFFFFFFULL, a_hi = a >> 32;
+        std::uint64_t b_lo = b & 0xFFFFFFFFULL, b_hi = b >> 32;
+        std::uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi;
+        std::uint64_t hl = a_hi * b_lo, hh = a_hi * b_hi;
+        std::uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFULL) + (hl & 0xFFFFFFFFULL);
+
+        Wide w;
+        w.lo = (mid << 32) | (ll & 0xFFFFFFFFULL);
+        w.hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+        return w;
+    }
+    static std::uint64_t wideLow51(const Wide &w) { return w.lo & MASK51; }
+    static std::uint64_t wideShift51(const Wide &w) { return (w.lo >> 51) | (w.hi << 13); }
+#endif
+
+    std::uint64_t limb[5];
+
+    // Propagate the carries of five wide column sums into a weakly reduced element
+    static Field25519 carryWide(Wide t0, Wide t1, Wide t2, Wide t3, Wide t4);
+
+    // One carry pass over 64-bit limbs, folding the overflow of limb 4 by 19
+    void carry();
+
+    // Fully reduce to the unique representative in [0, p)
+    Field25519 canonical() const;
+
+    Field25519 squareTimes(int count) const;
+
+    // Conditionally swap a and b when swap == 1, without branching on swap
+    static void conditionalSwap(Field25519 &a, Field25519 &b, std::uint64_t swap);
+
+    // Encode a non-negative BigNum below 2^256 as 32 little-endian bytes
+    static void scalarToBytes(const BigNum &scalar, std::uint8_t out[32]);
+
+public:
+    // Default constructor - creates zero
+    Field25519();
+
+    // Constructor from a small integer
+    explicit Field25519(std::uint64_t value);
+
+    // Constructor from BigNum: the value is reduced modulo p = 2^255 - 19
+    explicit Field25519(const BigNum &value);
+
+    // Decode 32 little-endian bytes; the top bit is ignored as in RFC 7748
+    static Field25519 fromBytes(const std::uint8_t in[32]);
+
+    // Encode the canonical representative as 32 little-endian bytes
+    void toBytes(std::uint8_t out[32]) const;
+
+    // Convert the canonical representative back to a BigNum
+    BigNum toBigNum() const;
+
+    bool isZero() const;
+
+    bool operator==(const Field25519 &other) const;
+
+    bool operator!=(const Field25519 &other) const;
+
+    // Addition (carries are left for the next multiplication)
+    Field25519 operator+(const Field25519 &other) const;
+
+    // Subtraction: adds 4p before subtracting so no limb underflows
+    Field25519 operator-(const Field25519 &other) const;
+
+    Field25519 operator-() const;
+
+    // Multiplication (schoolbook over five limbs, high half folded by 19)
+    Field25519 operator*(const Field25519 &other) const;
+
+    // Squaring (shares the symmetric cross products)
+    Field25519 square() const;
+
+    // Multiplication by a small constant (e.g. a24 = 121665)
+    Field25519 mulSmall(std::uint32_t factor) const;
+
+    // Multiplicative inverse via Fermat: a^(p-2), a fixed addition chain
+    Field25519 invert() const;
+
+    // X25519 (RFC 7748): scalar multiplication on the u-coordinate
+    static void x25519(std::uint8_t out[32], const std::uint8_t scalar[32], const std::uint8_t u[32]);
+
+    // X25519 on BigNums: scalar in [0, 2^256), u reduced modulo p
+    static BigNum x25519(const BigNum &scalar, const BigNum &u);
+};
+
+#endif // BIGNUM_HPP
@@ -0,0 +1,112 @@
+#ifndef BIGNUM_ASYNC_HPP
+#define BIGNUM_ASYNC_HPP
+
+#include "bignum.hpp"
+
+// Coroutine support needs C++20; in older modes this header declares nothing
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define BIGNUM_HAVE_ASYNC 1
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <utility>
+
+/**
+ * BigNumAwaitable - one library operation run on BigNumThreadPool::shared()
+ *
+ * co_await suspends the coroutine, runs the work on a pool worker and
+ * resumes the coroutine on that worker with the result, or rethrows what
+ * the work threw (BigNumCancelled if its stop token fired). Nothing runs
+ * until the awaitable is awaited, and it must be awaited at most once.
+ */
+template <typename T>
+class BigNumAwaitable
+{
+private:
+    std::function<T()> work;
+    T result;
+    std::exception_ptr error;
+
+public:
+    explicit BigNumAwaitable(std::function<T()> work) : work(std::move(work)), result() {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> waiter)
+    {
+        BigNumThreadPool::shared().submit([this, waiter]
+                                          {
+                                              try
+                                              {
+                                                  result = work();
+                                              }
+                                              catch (...)
+                                              {
+                                                  error = std::current_exception();
+                                              }
+                                              waiter.resume();
+                                          });
+    }
+
+    T await_resume()
+    {
+        if (error)
+            std::rethrow_exception(error);
+        return std::move(result);
+    }
+};
+
+/**
+ * BigNumAsync - awaitable versions of the long-running operations
+ *
+ *   BigNumStopSource stop;
+ *   BigNum r = co_await BigNumAsync::powMod(base, exp, m, stop.token(), onProgress);
+ *
+ * Operands are copied into the awaitable, so the caller's values may change
+ * or go away while it runs. The stop token and progress callback are
+ * checked and called between stages on the worker thread.
+ */
+class BigNumAsync
+{
+public:
+    // Runs as a single stage: the token is checked before it starts
+    static BigNumAwaitable<BigNum> mul(BigNum a, BigNum b, BigNumStopToken stop = BigNumStopToken(),
+                                       BigNumProgress progress = BigNumProgress())
+    {
+        return BigNumAwaitable<BigNum>([a = std::move(a), b = std::move(b), stop, progress]
+                                       {
+                                           stop.throwIfStopped();
+                                           BigNum product = a * b;
+                                           if (progress)
+                                               progress(1.0);
+                                           return product;
+                                       });
+    }
+
+    // Stages are exponent bits, progress is per byte; the context comes from the shared cache
+    static BigNumAwaitable<BigNum> powMod(BigNum base, BigNum exp, BigNum m,
+                                          BigNumStopToken stop = BigNumStopToken(),
+                                          BigNumProgress progress = BigNumProgress())
+    {
+        return BigNumAwaitable<BigNum>(
+            [base = std::move(base), exp = std::move(exp), m = std::move(m), stop, progress]
+            {
+                return BigNumModContextCache::shared().get(m)->powMod(base, exp, stop, progress);
+            });
+    }
+
+    // Stages are Miller-Rabin rounds
+    static BigNumAwaitable<bool> isPrime(BigNum n, int rounds = 25, BigNumStopToken stop = BigNumStopToken(),
+                                         BigNumProgress progress = BigNumProgress())
+    {
+        return BigNumAwaitable<bool>([n = std::move(n), rounds, stop, progress]
+                                     {
+                                         return n.isProbablePrime(rounds, stop, progress);
+                                     });
+    }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef BIGNUM_C_H
+#define BIGNUM_C_H
+
+/**
+ * bignum_c.h - C ABI of the BigNum library
+ *
+ * For callers that cannot use the C++ API directly (FFI from Go, Rust,
+ * Python, ...). Numbers and modulus contexts are opaque handles; values
+ * cross the boundary as big-endian magnitude bytes plus a sign flag, or as
+ * decimal text, always in buffers owned by the caller. No C++ exception
+ * escapes: every fallible call returns a bn_status.
+ *
+ * Buffer-filling calls take the capacity and report the length written
+ * through *len. If the buffer is too small they write nothing, set *len
+ * to the length required and return BN_ERR_BUFFER_TOO_SMALL, so a caller
+ * can size its buffer with a first call made with capacity 0.
+ *
+ * The batch entry points do a whole vector of operations per call, so
+ * the FFI crossing is paid once per batch rather than once per operation.
+ * Handles are not synchronized: a handle written by one thread must not be
+ * used by another at the same time. A bn_mod_ctx is read-only after
+ * creation and may be shared freely.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+#if defined(BIGNUM_STATIC)
+#define BIGNUM_C_API
+#elif defined(BIGNUM_BUILDING)
+#define BIGNUM_C_API __declspec(dllexport)
+#else
+#define BIGNUM_C_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define BIGNUM_C_API __attribute__((visibility("default")))
+#else
+#define BIGNUM_C_API
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef enum
+    {
+        BN_OK = 0,
+        BN_ERR_NULL_ARGUMENT = 1,    /* a required pointer was NULL */
+        BN_ERR_DIVISION_BY_ZERO = 2, /* zero divisor or modulus */
+        BN_ERR_NO_INVERSE = 3,       /* modular inverse does not exist */
+        BN_ERR_BUFFER_TOO_SMALL = 4, /* *len holds the size required */
+        BN_ERR_INVALID_ARGUMENT = 5, /* malformed input */
+        BN_ERR_NO_MEMORY = 6,
+        BN_ERR_INTERNAL = 7
+    } bn_status;
+
+    typedef struct bn_num bn_num;
+    typedef struct bn_mod_ctx bn_mod_ctx;
+
+    /* Version of the ABI described by this header */
+#define BIGNUM_C_ABI_VERSION 1
+    BIGNUM_C_API int bn_abi_version(void);
+
+    /* Static description of a status code */
+    BIGNUM_C_API const char *bn_status_string(int status);
+
+    /* Numbers: bn_new returns zero, or NULL if out of memory */
+    BIGNUM_C_API bn_num *bn_new(void);
+    BIGNUM_C_API void bn_free(bn_num *n);
+    BIGNUM_C_API int bn_copy(bn_num *dst, const bn_num *src);
+
+    BIGNUM_C_API int bn_set_i64(bn_num *n, int64_t value);
+    BIGNUM_C_API int bn_set_bytes(bn_num *n, const uint8_t *data, size_t len, int negative);
+    BIGNUM_C_API int bn_set_str(bn_num *n, const char *decimal);
+
+    /* Big-endian magnitude; zero is written as no bytes */
+    BIGNUM_C_API int bn_get_bytes(const bn_num *n, uint8_t *out, size_t capacity, size_t *len);
+    /* Decimal text, NUL-terminated; *len excludes the terminator */
+    BIGNUM_C_API int bn_get_str(const bn_num *n, char *out, size_t capacity, size_t *len);
+
+    /* NULL is neither negative nor zero */
+    BIGNUM_C_API int bn_is_negative(const bn_num *n);
+    BIGNUM_C_API int bn_is_zero(const bn_num *n);
+    /* -1, 0 or 1; NULL orders before every number and equals NULL */
+    BIGNUM_C_API int bn_cmp(const bn_num *a, const bn_num *b);
+
+    /* r may alias any operand */
+    BIGNUM_C_API int bn_add(bn_num *r, const bn_num *a, const bn_num *b);
+    BIGNUM_C_API int bn_sub(bn_num *r, const bn_num *a, const bn_num *b);
+    BIGNUM_C_API int bn_mul(bn_num *r, const bn_num *a, const bn_num *b);
+    BIGNUM_C_API int bn_div(bn_num *r, const bn_num *a, const bn_num *b);
+    BIGNUM_C_API int bn_mod(bn_num *r, const bn_num *a, const bn_num *b);
+
+    /* Modular operations; results are in [0, |m|) */
+    BIGNUM_C_API int bn_addmod(bn_num *r, const bn_num *a, const bn_num *b, const bn_num *m);
+    BIGNUM_C_API int bn_mulmod(bn_num *r, const bn_num *a, const bn_num *b, const bn_num *m);
+    BIGNUM_C_API int bn_powmod(bn_num *r, const bn_num *base, const bn_num *exp, const bn_num *m);
+    /* bn_powmod with timing independent of the exponent's bits, for private
+       keys; m must be odd, else BN_ERR_INVALID_ARGUMENT */
+    BIGNUM_C_API int bn_powmod_consttime(bn_num *r, const bn_num *base, const bn_num *exp, const bn_num *m);
+    BIGNUM_C_API int bn_modinverse(bn_num *r, const bn_num *a, const bn_num *m);
+
+    /* Modulus contexts: precomputation shared by every operation modulo m */
+    BIGNUM_C_API int bn_mod_ctx_new(bn_mod_ctx **ctx, const bn_num *m);
+    BIGNUM_C_API void bn_mod_ctx_free(bn_mod_ctx *ctx);
+    /* Bytes needed for any reduced value in bn_get_bytes form */
+    BIGNUM_C_API size_t bn_mod_ctx_byte_length(const bn_mod_ctx *ctx);
+
+    BIGNUM_C_API int bn_addmod_ctx(bn_num *r, const bn_num *a, const bn_num *b, const bn_mod_ctx *ctx);
+    BIGNUM_C_API int bn_mulmod_ctx(bn_num *r, const bn_num *a, const bn_num *b, const bn_mod_ctx *ctx);
+    BIGNUM_C_API int bn_powmod_ctx(bn_num *r, const bn_num *base, const bn_num *exp, const bn_mod_ctx *ctx);
+
+    /* results[i] = bases[i]^|exps[i]| mod m for i < count, spread across threads */
+    BIGNUM_C_API int bn_batch_powmod(bn_num *const *results, const bn_num *const *bases, const bn_num *const *exps,
+                                     size_t count, const bn_mod_ctx *ctx);
+
+    /*
+     * Same on packed buffers, with no handles at all: count big-endian
+     * non-negative bases of base_width bytes each and exponents of exp_width
+     * bytes each. Results are written left-padded to out_width bytes, which
+     * must be at least bn_mod_ctx_byte_length(ctx).
+     */
+    BIGNUM_C_API int bn_batch_powmod_bytes(uint8_t *out, size_t out_width, const uint8_t *bases, size_t base_width,
+                                           const uint8_t *exps, size_t exp_width, size_t count,
+                                           const bn_mod_ctx *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef BIGNUM_FLOAT_HPP
+#define BIGNUM_FLOAT_HPP
+
+#include "bignum.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+/**
+ * BigFloat - arbitrary-precision floating point on a BigNum mantissa
+ *
+ * A value is mantissa * 10^exponent, with no trailing zeros in the
+ * mantissa. The exponent is decimal because the mantissa is: scaling by
+ * a power of ten is a digit shift, where a binary exponent would cost a
+ * multiplication by 2^e. Precision is given in bits and held as
+ * 1 + ceil(bits * log10 2) decimal digits, enough that rounding is never
+ * coarser than a binary format of that many bits.
+ *
+ * add, sub, mul, div and sqrt are correctly rounded to the requested
+ * precision (to nearest, ties to even). The operators round to the larger
+ * precision of their operands.
+ *
+ *   mul   computes only the product digits that can affect the result (see
+ *         BigNum::mulShort), and falls back to the full product only when
+ *         those digits cannot settle the rounding
+ *   div   Newton reciprocal on BigNum's multiply, then one multiplication
+ *         to get the exact remainder that settles the last digit
+ *   sqrt  integer square root by one Newton step on those divisions, from
+ *         a half-size root, with a square to settle the last units
+ */
+class BIGNUM_API BigFloat
+{
+private:
+    BigNum mantissa_;       // no trailing zeros; 0 for zero
+    std::int64_t exponent_; // 0 for zero
+    int precision_;         // bits
+
+    // Round sign * magnitude * 10^exponent to precision. sticky means the
+    // exact value is slightly larger in magnitude than that, by less than
+    // one unit of the magnitude's last digit.
+    static BigFloat rounded(DigitVector &magnitude, bool negative, std::int64_t exponent, bool sticky, int precision);
+
+    // x * 10^places; negative places truncate toward zero
+    static BigNum shifted(const BigNum &x, std::int64_t places);
+
+    // About 10^(n + k) / d for the n-digit d > 0, within a few units
+    static BigNum reciprocal(const BigNum &d, std::size_t k);
+
+    // quotient = n / d, remainder = n - quotient * d, for n >= 0 and d > 0
+    static void divRem(const BigNum &n, const BigNum &d, BigNum &quotient, BigNum &remainder);
+
+    // Largest s with s * s <= n, for n >= 0
+    static BigNum isqrt(const BigNum &n);
+
+    static BigFloat add(const BigFloat &a, const BigFloat &b, int precision, bool negateB);
+
+public:
+    static const int DEFAULT_PRECISION = 256;
+
+    // Zero
+    BigFloat();
+
+    // value rounded to precision bits
+    explicit BigFloat(const BigNum &value, int precision = DEFAULT_PRECISION);
+
+    // mantissa * 10^exponent rounded to precision bits
+    BigFloat(const BigNum &mantissa, std::int64_t exponent, int precision);
+
+    // "-12.5", "3e-7", "0.125E+3", rounded to precision bits; throws runtime_error if malformed
+    explicit BigFloat(const std::string &text, int precision = DEFAULT_PRECISION);
+    explicit BigFloat(const char *text, int precision = DEFAULT_PRECISION);
+
+    // Decimal digits held for a precision in bits; throws runtime_error if bits < 1
+    static std::size_t digitsForPrecision(int bits);
+
+    int precision() const { return precision_; }
+    const BigNum &mantissa() const { return mantissa_; }
+    std::int64_t exponent() const { return exponent_; }
+
+    bool isZero() const { return mantissa_.isZero(); }
+
+    // -1, 0 or 1
+    int sign() const;
+
+    // Correctly rounded to precision bits
+    static BigFloat add(const BigFloat &a, const BigFloat &b, int precision);
+    static BigFloat sub(const BigFloat &a, const BigFloat &b, int precision);
+    static BigFloat mul(const BigFloat &a, const BigFloat &b, int precision);
+
+    // Throws runtime_error if b is zero
+    static BigFloat div(const BigFloat &a, const BigFloat &b, int precision);
+
+    // Throws runtime_error if a is negative
+    static BigFloat sqrt(const BigFloat &a, int precision);
+
+    BigFloat operator-() const;
+    BigFloat operator+(const BigFloat &other) const;
+    BigFloat operator-(const BigFloat &other) const;
+    BigFloat operator*(const BigFloat &other) const;
+    BigFloat operator/(const BigFloat &other) const;
+    BigFloat sqrt() const;
+
+    // Exact comparisons of the values, whatever their precisions
+    bool operator==(const BigFloat &other) const;
+    bool operator<(const BigFloat &other) const;
+
+    bool operator!=(const BigFloat &other) const
+    {
+        return !(*this == other);
+    }
+
+    bool operator<=(const BigFloat &other) const
+    {
+        return !(other < *this);
+    }
+
+    bool operator>(const BigFloat &other) const
+    {
+        return other < *this;
+    }
+
+    bool operator>=(const BigFloat &other) const
+    {
+        return !(*this < other);
+    }
+
+    // Integer part (truncated toward zero)
+    BigNum toBigNum() const;
+
+    // Positional when the decimal exponent is in (-7, 21), e.g. "0.001",
+    // "-12.5"; otherwise scientific, e.g. "1.25e+30"
+    std::string toString() const;
+
+    friend std::ostream &operator<<(std::ostream &os, const BigFloat &value);
+};
+
+BIGNUM_API std::ostream &operator<<(std::ostream &os, const BigFloat &value);
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef BIGNUM_RATIONAL_HPP
+#define BIGNUM_RATIONAL_HPP
+
+#include "bignum.hpp"
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+/**
+ * BigRational - exact fraction of two BigNums
+ *
+ * The denominator is always positive and the sign lives in the numerator.
+ * Reduction to lowest terms is lazy. While the operands of an operation
+ * hold at most normalizeThreshold() digits between them, the result is
+ * left as computed and no gcd is taken. Past that size the operands are
+ * brought to lowest terms and combined with cross gcds:
+ *
+ *   (a/b) * (c/d)  cancels gcd(a, d) and gcd(c, b) before multiplying
+ *   (a/b) + (c/d)  works with g = gcd(b, d) and then gcd(a (d/g) + c (b/g), g)
+ *
+ * Those gcds are of operand-sized values rather than of the product, and
+ * the result is already in lowest terms. canonicalize() reduces on demand.
+ *
+ * Comparisons and toString() give the same answers whether or not a value
+ * has been reduced; numerator() and denominator() return the terms as
+ * stored.
+ */
+class BIGNUM_API BigRational
+{
+private:
+    BigNum num_;
+    BigNum den_;   // > 0
+    bool reduced_; // known to be in lowest terms
+
+    // Terms that already satisfy the invariants; zero is stored as 0/1
+    BigRational(BigNum num, BigNum den, bool reduced);
+
+    // Digits held by both terms
+    std::size_t digitCount() const;
+
+    // Copy in lowest terms
+    BigRational reduced() const;
+
+    static BigRational add(const BigRational &a, const BigRational &b, bool negateB);
+    static BigRational multiply(const BigRational &a, const BigRational &b);
+
+public:
+    static const std::size_t DEFAULT_NORMALIZE_THRESHOLD = 64;
+
+    // Zero
+    BigRational();
+
+    BigRational(const BigNum &value);
+    BigRational(long long value);
+
+    // num / den, not necessarily in lowest terms; throws runtime_error if den is zero
+    BigRational(const BigNum &num, const BigNum &den);
+
+    // "n" or "n/d"; throws runtime_error if malformed or d is zero
+    explicit BigRational(const std::string &text);
+    explicit BigRational(const char *text);
+
+    // Operand size (digits of all four terms) from which results are reduced
+    static void setNormalizeThreshold(std::size_t digits);
+    static std::size_t normalizeThreshold();
+
+    // Divide both terms by their gcd
+    BigRational &canonicalize();
+
+    bool isCanonical() const { return reduced_; }
+
+    const BigNum &numerator() const { return num_; }
+    const BigNum &denominator() const { return den_; }
+
+    bool isZero() const { return num_.isZero(); }
+    bool isInteger() const;
+
+    // -1, 0 or 1
+    int sign() const;
+
+    BigRational operator-() const;
+
+    BigRational operator+(const BigRational &other) const;
+    BigRational operator-(const BigRational &other) const;
+    BigRational operator*(const BigRational &other) const;
+
+    // Throws runtime_error if other is zero
+    BigRational operator/(const BigRational &other) const;
+
+    BigRational &operator+=(const BigRational &other);
+    BigRational &operator-=(const BigRational &other);
+    BigRational &operator*=(const BigRational &other);
+    BigRational &operator/=(const BigRational &other);
+
+    bool operator==(const BigRational &other) const;
+    bool operator<(const BigRational &other) const;
+
+    bool operator!=(const BigRational &other) const
+    {
+        return !(*this == other);
+    }
+
+    bool operator<=(const BigRational &other) const
+    {
+        return !(other < *this);
+    }
+
+    bool operator>(const BigRational &other) const
+    {
+        return other < *this;
+    }
+
+    bool operator>=(const BigRational &other) const
+    {
+        return !(*this < other);
+    }
+
+    // Lowest terms, "n/d", or "n" when the denominator is 1
+    std::string toString() const;
+
+    friend std::ostream &operator<<(std::ostream &os, const BigRational &value);
+};
+
+BIGNUM_API std::ostream &operator<<(std::ostream &os, const BigRational &value);
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef BIGNUM_RPC_HPP
+#define BIGNUM_RPC_HPP
+
+#include "bignum.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Wire protocol of BigNumCalculator --serve
+ *
+ * Every message is one frame:
+ *
+ *   u32 length     bytes in the rest of the frame
+ *   u32 id         chosen by the client, echoed in the response
+ *   u16 code       opcode in a request, status in a response
+ *   u16 count      number of operands that follow
+ *   operands       each one laid out like a BigNumArchive entry: u32 flags
+ *                  (bit 0 = negative), u32 digit count, then that many i32
+ *                  decimal digits, least significant first, no leading zeros
+ *
+ * Integers are in host byte order, since both ends share a machine, and
+ * every field stays 4-byte aligned. A client may pipeline any number of
+ * requests on one connection. Responses come back as soon as each result
+ * is ready, so they can arrive out of order and are matched by id. A
+ * successful response carries one operand (none for RPC_PING); a failed
+ * one carries none.
+ */
+enum BigNumRpcOp
+{
+    RPC_PING,
+    RPC_ADD,
+    RPC_SUB,
+    RPC_MUL,
+    RPC_DIV,
+    RPC_MOD,
+    RPC_ADDMOD,  // a, b, m
+    RPC_MULMOD,  // a, b, m
+    RPC_POWMOD,  // base, exp, m
+    RPC_INVERSE, // a, m
+    RPC_OP_COUNT
+};
+
+enum BigNumRpcStatus
+{
+    RPC_OK,
+    RPC_BAD_REQUEST, // unknown opcode, wrong operand count or malformed operand
+    RPC_DIVISION_BY_ZERO,
+    RPC_NO_INVERSE,
+    RPC_FAILED,
+    RPC_DEADLINE_EXCEEDED // the server's --budget ran out
+};
+
+struct BigNumRpcFrame
+{
+    std::uint32_t id;
+    std::uint16_t code;
+    std::vector<BigNum> operands;
+
+    BigNumRpcFrame() : id(0), code(0) {}
+};
+
+class BIGNUM_API BigNumRpc
+{
+public:
+    static const std::size_t LENGTH_SIZE = 4;
+    static const std::size_t HEADER_SIZE = 8; // id, code, count
+    static const std::uint32_t MAX_FRAME = 64u << 20;
+
+    // Operands an opcode takes, or -1 if it is unknown
+    static int arity(int op);
+
+    static const char *opName(int op);
+    static const char *statusName(int status);
+
+    // Append the frame, length prefix included
+    static void encode(std::vector<std::uint8_t> &out, const BigNumRpcFrame &frame);
+
+    // Parse a frame body (everything after the length prefix); throws
+    // runtime_error if it is malformed
+    static BigNumRpcFrame decode(const std::uint8_t *body, std::size_t size);
+};
+
+#endif
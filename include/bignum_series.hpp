@@ -0,0 +1,66 @@
+#ifndef BIGNUM_SERIES_HPP
+#define BIGNUM_SERIES_HPP
+
+#include "bignum.hpp"
+#include "bignum_float.hpp"
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * BigNumSeries - binary splitting for hypergeometric-type series
+ *
+ * Evaluates S = sum over n of a(n) * p(0)/q(0) * ... * p(n)/q(n), where
+ * p, q and a are small integers for each term. Over a range of terms the
+ * series is carried as three integers:
+ *
+ *   P = p(n1) ... p(n2 - 1)      Q = q(n1) ... q(n2 - 1)
+ *   T = Q * (the partial sum over [n1, n2) with p(n1)/q(n1) as first factor)
+ *
+ * and two halves combine as P = Pl Pr, Q = Ql Qr, T = Tl Qr + Pl Tr, so
+ * that the multiplications pair operands of similar size and the sum is
+ * T / Q. The top levels of the recursion fork their right half onto
+ * BigNumThreadPool::shared(). A forked half that no worker has started yet
+ * when its parent needs it is run by the parent instead, so nested forks
+ * never wait on a queue that only they could drain.
+ *
+ * The constants are computed with 64 guard bits and rounded to the
+ * requested precision. They are within one unit in the last place, and
+ * correctly rounded unless the value lies that close to a rounding
+ * boundary.
+ */
+class BIGNUM_API BigNumSeries
+{
+public:
+    // Sets p(n), q(n) and a(n) of term n; q(n) must be non-zero
+    typedef std::function<void(std::uint64_t n, BigNum &p, BigNum &q, BigNum &a)> Term;
+
+    struct Split
+    {
+        BigNum p, q, t;
+    };
+
+    // P, Q and T over the terms [begin, end), begin < end. The top depth
+    // levels fork onto the shared pool; a negative depth picks one level
+    // per doubling of the hardware threads. Exceptions from term reach the
+    // caller.
+    static Split split(const Term &term, std::uint64_t begin, std::uint64_t end, int depth = -1);
+
+    // The sum of terms [0, terms) rounded to precision bits
+    static BigFloat sum(const Term &term, std::uint64_t terms, int precision);
+
+    // Chudnovsky: 1/pi = 12 sum (-1)^n (6n)! (13591409 + 545140134 n) / ((3n)! (n!)^3 640320^(3n + 3/2))
+    static BigFloat pi(int precision);
+
+    // sum 1/n!
+    static BigFloat e(int precision);
+
+    // 3/4 sum (-1)^n (n!)^2 / (2^n (2n + 1)!)
+    static BigFloat log2(int precision);
+
+    // Euler: arctan(1/x) = sum 2^(2n) (n!)^2 / (2n + 1)! * x / (x^2 + 1)^(n + 1);
+    // throws runtime_error if x is zero
+    static BigFloat arctanInverse(std::uint32_t x, int precision);
+};
+
+#endif
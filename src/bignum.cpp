@@ -0,0 +1,3335 @@
+#include "bignum.hpp"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <exception>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <cctype>
+#include <future>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <type_traits>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <cstdio>
+#if defined(BIGNUM_STATS) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+#if BIGNUM_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Algorithm crossover defaults; a header generated by BigNumTune can replace
+// them at compile time (-DBIGNUM_TUNING_HEADER='"bignum_tuning.h"')
+#ifdef BIGNUM_TUNING_HEADER
+#include BIGNUM_TUNING_HEADER
+#endif
+
+#ifndef BIGNUM_KARATSUBA_THRESHOLD
+#define BIGNUM_KARATSUBA_THRESHOLD 32
+#endif
+
+void MappedFile::release()
+{
+#if BIGNUM_HAVE_MMAP
+    if (base && length > 0)
+    {
+        munmap(base, length);
+    }
+#else
+    if (writable)
+    {
+        ofstream out(writePath.c_str(), ios::binary | ios::trunc);
+        out.write(buffer.data(), buffer.size());
+    }
+    buffer.clear();
+#endif
+    base = nullptr;
+    length = 0;
+}
+
+MappedFile::MappedFile(MappedFile &&other) : base(other.base), length(other.length), writable(other.writable)
+#if !BIGNUM_HAVE_MMAP
+      ,
+      buffer(std::move(other.buffer)), writePath(std::move(other.writePath))
+#endif
+{
+#if !BIGNUM_HAVE_MMAP
+    base = buffer.data();
+#endif
+    other.base = nullptr;
+    other.length = 0;
+    other.writable = false;
+}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+MappedFile MappedFile::openRead(const string &path)
+{
+    MappedFile file;
+#if BIGNUM_HAVE_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw runtime_error("Cannot open file: " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        throw runtime_error("Cannot stat file: " + path);
+    }
+    file.length = info.st_size;
+    if (file.length > 0)
+    {
+        void *p = mmap(nullptr, file.length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            throw runtime_error("Cannot map file: " + path);
+        }
+        file.base = static_cast<char *>(p);
+        madvise(p, file.length, MADV_SEQUENTIAL);
+    }
+    close(fd);
+#else
+    ifstream in(path.c_str(), ios::binary);
+    if (!in)
+    {
+        throw runtime_error("Cannot open file: " + path);
+    }
+    file.buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    file.base = file.buffer.data();
+    file.length = file.buffer.size();
+#endif
+    return file;
+}
+
+MappedFile MappedFile::create(const string &path, size_t size)
+{
+    MappedFile file;
+    file.writable = true;
+#if BIGNUM_HAVE_MMAP
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        throw runtime_error("Cannot create file: " + path);
+    }
+    if (ftruncate(fd, size) != 0)
+    {
+        close(fd);
+        throw runtime_error("Cannot resize file: " + path);
+    }
+    file.length = size;
+    if (size > 0)
+    {
+        void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            throw runtime_error("Cannot map file: " + path);
+        }
+        file.base = static_cast<char *>(p);
+    }
+    close(fd);
+#else
+    file.writePath = path;
+    file.buffer.assign(size, 0);
+    file.base = file.buffer.data();
+    file.length = size;
+#endif
+    return file;
+}
+
+BigNumTuning::BigNumTuning() : karatsubaThreshold(BIGNUM_KARATSUBA_THRESHOLD) {}
+
+void BigNumTuning::load(const string &path)
+{
+    ifstream in(path.c_str());
+    if (!in)
+    {
+        throw runtime_error("Cannot open tuning file: " + path);
+    }
+
+    string line;
+    while (getline(in, line))
+    {
+        line = line.substr(0, line.find('#'));
+        size_t eq = line.find('=');
+        if (eq == string::npos)
+        {
+            if (line.find_first_not_of(" \t\r") != string::npos)
+                throw runtime_error("Malformed line in tuning file: " + line);
+            continue;
+        }
+
+        string key = line.substr(0, eq);
+        key.erase(remove_if(key.begin(), key.end(), ::isspace), key.end());
+        char *end;
+        unsigned long long value = strtoull(line.c_str() + eq + 1, &end, 10);
+        if (end == line.c_str() + eq + 1)
+            throw runtime_error("Malformed value in tuning file: " + line);
+
+        if (key == "karatsuba_threshold")
+            karatsubaThreshold = max<size_t>(4, value);
+    }
+}
+
+void BigNumTuning::save(const string &path) const
+{
+    ofstream out(path.c_str());
+    if (!out)
+    {
+        throw runtime_error("Cannot write tuning file: " + path);
+    }
+    out << "karatsuba_threshold = " << karatsubaThreshold << "\n";
+}
+
+BigNumTuning BigNumTuning::fromEnvironment()
+{
+    BigNumTuning tuning;
+    const char *path = getenv("BIGNUM_TUNING");
+    if (path && *path)
+    {
+        try
+        {
+            tuning.load(path);
+        }
+        catch (const exception &e)
+        {
+            cerr << "BigNum: ignoring tuning file: " << e.what() << endl;
+            tuning = BigNumTuning();
+        }
+    }
+    return tuning;
+}
+
+BigNumStats::BigNumStats() : enabled(false)
+{
+    memset(records, 0, sizeof records);
+}
+
+const char *BigNumStats::name(int stat)
+{
+    static const char *const names[STAT_COUNT] = {
+        "mul.schoolbook", "mul.karatsuba", "divmod", "reduce.division", "reduce.context",
+        "addMod", "mulMod", "powMod.window1", "modInverse", "powMod.consttime", "powMod.ladder", "other"};
+    return names[stat];
+}
+
+void BigNumStats::dump(ostream &os) const
+{
+    if (!enabled)
+    {
+        os << "BigNum stats disabled (build with -DBIGNUM_STATS)" << endl;
+        return;
+    }
+
+    char line[160];
+    snprintf(line, sizeof line, "%-16s %12s %14s %12s %14s %16s %12s\n", "primitive", "calls", "limbs",
+             "allocs", "bytes", "cycles", "cycles/call");
+    os << line;
+    for (int i = 0; i < STAT_COUNT; i++)
+    {
+        const BigNumStatRecord &r = records[i];
+        if (r.calls == 0 && r.allocations == 0)
+            continue;
+        snprintf(line, sizeof line, "%-16s %12llu %14llu %12llu %14llu %16llu %12.0f\n", name(i),
+                 (unsigned long long)r.calls, (unsigned long long)r.limbs,
+                 (unsigned long long)r.allocations, (unsigned long long)r.bytes,
+                 (unsigned long long)r.cycles, r.calls ? (double)r.cycles / r.calls : 0.0);
+        os << line;
+    }
+}
+
+#ifdef BIGNUM_STATS
+
+// Cycle counter: TSC on x86, nanoseconds elsewhere
+inline uint64_t bignumCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+class BigNumStatsRegistry
+{
+private:
+    friend class BigNumStatScope;
+
+    // One thread's counters; only the owning thread writes, any thread may read
+    struct Block
+    {
+        atomic<uint64_t> values[STAT_COUNT][5];
+        int current; // innermost active primitive, for allocation attribution
+
+        Block() : current(STAT_OTHER)
+        {
+            for (int i = 0; i < STAT_COUNT; i++)
+                for (int j = 0; j < 5; j++)
+                    values[i][j].store(0, memory_order_relaxed);
+            instance().attach(this);
+        }
+
+        ~Block()
+        {
+            instance().detach(this);
+        }
+
+        void add(int stat, int field, uint64_t amount)
+        {
+            atomic<uint64_t> &v = values[stat][field];
+            v.store(v.load(memory_order_relaxed) + amount, memory_order_relaxed);
+        }
+    };
+
+    mutex lock;
+    vector<Block *> live;
+    BigNumStats retired; // totals of threads that have exited
+
+    static void accumulate(BigNumStats &into, const Block &block)
+    {
+        for (int i = 0; i < STAT_COUNT; i++)
+        {
+            const atomic<uint64_t> *v = block.values[i];
+            BigNumStatRecord &r = into.records[i];
+            r.calls += v[CALLS].load(memory_order_relaxed);
+            r.limbs += v[LIMBS].load(memory_order_relaxed);
+            r.allocations += v[ALLOCATIONS].load(memory_order_relaxed);
+            r.bytes += v[BYTES].load(memory_order_relaxed);
+            r.cycles += v[CYCLES].load(memory_order_relaxed);
+        }
+    }
+
+    void attach(Block *block)
+    {
+        lock_guard<mutex> guard(lock);
+        live.push_back(block);
+    }
+
+    void detach(Block *block)
+    {
+        lock_guard<mutex> guard(lock);
+        accumulate(retired, *block);
+        live.erase(find(live.begin(), live.end(), block));
+    }
+
+public:
+    enum Field
+    {
+        CALLS,
+        LIMBS,
+        ALLOCATIONS,
+        BYTES,
+        CYCLES
+    };
+
+    static BigNumStatsRegistry &instance()
+    {
+        static BigNumStatsRegistry registry;
+        return registry;
+    }
+
+    static Block &local()
+    {
+        static thread_local Block block;
+        return block;
+    }
+
+    BigNumStats merged()
+    {
+        lock_guard<mutex> guard(lock);
+        BigNumStats total = retired;
+        for (Block *block : live)
+            accumulate(total, *block);
+        total.enabled = true;
+        return total;
+    }
+
+    void reset()
+    {
+        lock_guard<mutex> guard(lock);
+        retired = BigNumStats();
+        for (Block *block : live)
+            for (int i = 0; i < STAT_COUNT; i++)
+                for (int j = 0; j < 5; j++)
+                    block->values[i][j].store(0, memory_order_relaxed);
+    }
+
+    static void recordAllocation(size_t bytes)
+    {
+        Block &block = local();
+        block.add(block.current, ALLOCATIONS, 1);
+        block.add(block.current, BYTES, bytes);
+    }
+};
+
+// Times one primitive call and makes it the target of nested allocations
+class BigNumStatScope
+{
+private:
+    int stat;
+    int previous;
+    uint64_t start;
+
+public:
+    BigNumStatScope(int primitive, size_t limbs) : stat(primitive)
+    {
+        BigNumStatsRegistry::Block &block = BigNumStatsRegistry::local();
+        block.add(stat, BigNumStatsRegistry::CALLS, 1);
+        block.add(stat, BigNumStatsRegistry::LIMBS, limbs);
+        previous = block.current;
+        block.current = stat;
+        start = bignumCycles();
+    }
+
+    ~BigNumStatScope()
+    {
+        BigNumStatsRegistry::Block &block = BigNumStatsRegistry::local();
+        block.add(stat, BigNumStatsRegistry::CYCLES, bignumCycles() - start);
+        block.current = previous;
+    }
+};
+
+#define BIGNUM_STAT_SCOPE(stat, limbs) BigNumStatScope bignum_stat_scope_(stat, limbs)
+#define BIGNUM_STAT_ALLOCATION(bytes) BigNumStatsRegistry::recordAllocation(bytes)
+#else
+#define BIGNUM_STAT_SCOPE(stat, limbs) ((void)0)
+#define BIGNUM_STAT_ALLOCATION(bytes) ((void)0)
+#endif
+
+// Plain thread_local PODs: zero-initialized, no guard or destructor per thread
+static thread_local BigNumAllocationCount threadAllocationCount;
+static thread_local int threadAllocationForbidden;
+
+atomic<BigNumAllocationHook> &BigNumAllocationTracker::hook()
+{
+    static atomic<BigNumAllocationHook> current(nullptr);
+    return current;
+}
+
+BigNumAllocationCount BigNumAllocationTracker::local()
+{
+    return threadAllocationCount;
+}
+
+void BigNumAllocationTracker::record(size_t bytes)
+{
+    if (threadAllocationForbidden > 0)
+        throw runtime_error("BigNum allocated inside a BigNumNoAllocationScope");
+
+    threadAllocationCount.allocations++;
+    threadAllocationCount.bytes += bytes;
+    BIGNUM_STAT_ALLOCATION(bytes);
+
+    BigNumAllocationHook observer = hook().load(memory_order_acquire);
+    if (observer)
+        observer(bytes);
+}
+
+BigNumNoAllocationScope::BigNumNoAllocationScope()
+{
+    threadAllocationForbidden++;
+}
+
+BigNumNoAllocationScope::~BigNumNoAllocationScope()
+{
+    threadAllocationForbidden--;
+}
+
+// Sanitizers must see every free, so they get the heap directly
+#if !defined(BIGNUM_NO_POOL) && (defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__))
+#define BIGNUM_NO_POOL
+#endif
+#if !defined(BIGNUM_NO_POOL) && defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#define BIGNUM_NO_POOL
+#endif
+#endif
+
+static const size_t LIMB_POOL_CLASSES = 10;
+static_assert((BigNumLimbPool::MIN_BLOCK << (LIMB_POOL_CLASSES - 1)) == BigNumLimbPool::MAX_BLOCK,
+              "size classes must cover MIN_BLOCK..MAX_BLOCK");
+
+struct LimbCache;
+
+// Prefix of every pooled block; keeps the payload 16-byte aligned
+struct alignas(16) LimbBlockHeader
+{
+    LimbCache *owner; // nullptr if the allocating thread had already exited its pool
+    uint32_t sizeClass;
+};
+
+// One thread's pool. Free blocks are linked through their first payload word.
+struct LimbCache
+{
+    void *lists[LIMB_POOL_CLASSES];
+    size_t retained;
+    BigNumLimbPoolStats stats;
+    atomic<void *> returned; // pushed by any thread, taken whole by the owner
+};
+
+// Pools of exited threads, waiting for a new thread to adopt them
+struct LimbCacheRegistry
+{
+    mutex lock;
+    vector<LimbCache *> parked;
+};
+
+static thread_local LimbCache *threadLimbCache;
+static thread_local bool threadLimbCacheRetired;
+static atomic<size_t> limbPoolRetainLimit(BigNumLimbPool::DEFAULT_RETAIN_LIMIT);
+
+static LimbCacheRegistry &limbCacheRegistry()
+{
+    // Never destroyed: digits may still be freed during static destruction
+    static LimbCacheRegistry *registry = new LimbCacheRegistry();
+    return *registry;
+}
+
+static inline void *&blockLink(void *payload)
+{
+    return *static_cast<void **>(payload);
+}
+
+static inline LimbBlockHeader *blockHeader(void *payload)
+{
+    return static_cast<LimbBlockHeader *>(payload) - 1;
+}
+
+static inline size_t classBytes(size_t sizeClass)
+{
+    return BigNumLimbPool::MIN_BLOCK << sizeClass;
+}
+
+static inline size_t sizeClassFor(size_t bytes)
+{
+    size_t sizeClass = 0;
+    while (classBytes(sizeClass) < bytes)
+        sizeClass++;
+    return sizeClass;
+}
+
+// Keep a free block for reuse, or give it back if the cache is full (owner thread only)
+static void cacheBlock(LimbCache &cache, void *payload, size_t sizeClass)
+{
+    size_t bytes = classBytes(sizeClass);
+    if (cache.retained + bytes > limbPoolRetainLimit.load(memory_order_relaxed))
+    {
+        ::operator delete(blockHeader(payload));
+        return;
+    }
+    blockLink(payload) = cache.lists[sizeClass];
+    cache.lists[sizeClass] = payload;
+    cache.retained += bytes;
+}
+
+// Move blocks freed by other threads into the free lists (owner thread only)
+static void reclaimReturned(LimbCache &cache)
+{
+    void *payload = cache.returned.exchange(nullptr, memory_order_acquire);
+    while (payload)
+    {
+        void *next = blockLink(payload);
+        cacheBlock(cache, payload, blockHeader(payload)->sizeClass);
+        payload = next;
+    }
+}
+
+// Give every cached and returned block back to the heap; yields the bytes released
+static size_t drainCache(LimbCache &cache)
+{
+    size_t released = 0;
+    for (size_t c = 0; c < LIMB_POOL_CLASSES; c++)
+    {
+        while (void *payload = cache.lists[c])
+        {
+            cache.lists[c] = blockLink(payload);
+            ::operator delete(blockHeader(payload));
+            released += classBytes(c);
+        }
+    }
+    cache.retained = 0;
+
+    void *payload = cache.returned.exchange(nullptr, memory_order_acquire);
+    while (payload)
+    {
+        void *next = blockLink(payload);
+        released += classBytes(blockHeader(payload)->sizeClass);
+        ::operator delete(blockHeader(payload));
+        payload = next;
+    }
+    return released;
+}
+
+// Runs at thread exit: empties the pool and parks it for adoption
+struct LimbCacheRelease
+{
+    ~LimbCacheRelease()
+    {
+        LimbCache *cache = threadLimbCache;
+        threadLimbCache = nullptr;
+        threadLimbCacheRetired = true;
+        if (!cache)
+            return;
+        drainCache(*cache);
+        LimbCacheRegistry &registry = limbCacheRegistry();
+        lock_guard<mutex> guard(registry.lock);
+        registry.parked.push_back(cache);
+    }
+};
+
+static LimbCache *acquireLimbCache()
+{
+    if (threadLimbCacheRetired)
+        return nullptr;
+    static thread_local LimbCacheRelease release; // registers the exit hook
+    (void)release;
+
+    LimbCache *cache = nullptr;
+    {
+        LimbCacheRegistry &registry = limbCacheRegistry();
+        lock_guard<mutex> guard(registry.lock);
+        if (!registry.parked.empty())
+        {
+            cache = registry.parked.back();
+            registry.parked.pop_back();
+        }
+    }
+    if (!cache)
+        cache = new LimbCache();
+    cache->stats = BigNumLimbPoolStats();
+    threadLimbCache = cache;
+    return cache;
+}
+
+void *BigNumLimbPool::allocate(size_t bytes)
+{
+#ifdef BIGNUM_NO_POOL
+    return ::operator new(bytes);
+#else
+    if (bytes > MAX_BLOCK)
+        return ::operator new(bytes);
+
+    size_t sizeClass = sizeClassFor(bytes);
+    LimbCache *cache = threadLimbCache ? threadLimbCache : acquireLimbCache();
+    if (cache)
+    {
+        if (!cache->lists[sizeClass] && cache->returned.load(memory_order_relaxed))
+            reclaimReturned(*cache);
+        void *payload = cache->lists[sizeClass];
+        if (payload)
+        {
+            cache->lists[sizeClass] = blockLink(payload);
+            cache->retained -= classBytes(sizeClass);
+            cache->stats.hits++;
+            return payload;
+        }
+        cache->stats.misses++;
+    }
+
+    LimbBlockHeader *header =
+        static_cast<LimbBlockHeader *>(::operator new(sizeof(LimbBlockHeader) + classBytes(sizeClass)));
+    header->owner = cache;
+    header->sizeClass = (uint32_t)sizeClass;
+    return header + 1;
+#endif
+}
+
+void BigNumLimbPool::deallocate(void *p, size_t bytes) noexcept
+{
+#ifdef BIGNUM_NO_POOL
+    (void)bytes;
+    ::operator delete(p);
+#else
+    if (!p)
+        return;
+    if (bytes > MAX_BLOCK)
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    LimbBlockHeader *header = blockHeader(p);
+    LimbCache *owner = header->owner;
+    if (!owner)
+    {
+        ::operator delete(header);
+    }
+    else if (owner == threadLimbCache)
+    {
+        cacheBlock(*owner, p, header->sizeClass);
+    }
+    else
+    {
+        // Only the owner pops, and it takes the whole stack at once, so a
+        // plain CAS push has no ABA problem
+        void *head = owner->returned.load(memory_order_relaxed);
+        do
+        {
+            blockLink(p) = head;
+        } while (!owner->returned.compare_exchange_weak(head, p, memory_order_release, memory_order_relaxed));
+        if (threadLimbCache)
+            threadLimbCache->stats.remoteFrees++;
+    }
+#endif
+}
+
+void BigNumLimbPool::setRetainLimit(size_t bytes)
+{
+    limbPoolRetainLimit.store(bytes, memory_order_relaxed);
+}
+
+size_t BigNumLimbPool::retainLimit()
+{
+    return limbPoolRetainLimit.load(memory_order_relaxed);
+}
+
+size_t BigNumLimbPool::trim()
+{
+    size_t released = 0;
+#ifndef BIGNUM_NO_POOL
+    if (threadLimbCache)
+        released += drainCache(*threadLimbCache);
+
+    // Parked pools have no owner to reclaim their returns; the registry lock
+    // keeps adoption out while we drain them
+    LimbCacheRegistry &registry = limbCacheRegistry();
+    lock_guard<mutex> guard(registry.lock);
+    for (LimbCache *cache : registry.parked)
+    {
+        released += drainCache(*cache);
+    }
+#endif
+    return released;
+}
+
+BigNumLimbPoolStats BigNumLimbPool::local()
+{
+    BigNumLimbPoolStats stats = BigNumLimbPoolStats();
+    if (threadLimbCache)
+    {
+        stats = threadLimbCache->stats;
+        stats.retainedBytes = threadLimbCache->retained;
+    }
+    return stats;
+}
+
+void BigNum::removeLeadingZeros()
+{
+    while (digits.size() > 1 && digits.back() == 0)
+    {
+        digits.pop_back();
+    }
+}
+
+int BigNum::compareMagnitude(const int *a, size_t na, const int *b, size_t nb)
+{
+    if (na != nb)
+        return na < nb ? -1 : 1;
+    for (size_t i = na; i-- > 0;)
+    {
+        if (a[i] != b[i])
+            return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+BigNumTuning &BigNum::tuningStorage()
+{
+    static BigNumTuning tuning = BigNumTuning::fromEnvironment();
+    return tuning;
+}
+
+// The schoolbook row kernel is compiled once per instruction set and the
+// best clone is picked by the dynamic loader on first call, so a single
+// libbignum binary uses AVX2 where it exists without -march=native
+#if !defined(BIGNUM_NO_DISPATCH) && defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && \
+    defined(__ELF__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define BIGNUM_KERNEL __attribute__((target_clones("avx2", "default")))
+#endif
+#endif
+#ifndef BIGNUM_KERNEL
+#define BIGNUM_KERNEL
+#endif
+
+// Rows accumulated between carry passes: 81 * 2^24 plus a carried-in digit
+// stays below INT_MAX
+static const size_t SCHOOLBOOK_CARRY_INTERVAL = size_t(1) << 24;
+
+BIGNUM_KERNEL static void mulAddRow(int *r, const int *b, size_t n, int factor)
+{
+    for (size_t j = 0; j < n; j++)
+    {
+        r[j] += factor * b[j];
+    }
+}
+
+static void propagateCarries(int *r, size_t n)
+{
+    int carry = 0;
+    for (size_t k = 0; k < n; k++)
+    {
+        int v = r[k] + carry;
+        carry = v / 10;
+        r[k] = v - 10 * carry;
+    }
+}
+
+// r[0 .. na + nb) = a * b, with r zeroed by the caller
+static void mulSchoolbookInto(int *r, const int *a, size_t na, const int *b, size_t nb)
+{
+    // Column sums are accumulated without carrying so the inner loop is a
+    // plain multiply-add the kernel can vectorize
+    for (size_t i = 0; i < na; i++)
+    {
+        if (a[i] != 0)
+            mulAddRow(r + i, b, nb, a[i]);
+        if ((i + 1) % SCHOOLBOOK_CARRY_INTERVAL == 0)
+            propagateCarries(r, na + nb);
+    }
+    propagateCarries(r, na + nb);
+}
+
+DigitVector BigNum::mulSchoolbook(const int *a, size_t na, const int *b, size_t nb)
+{
+    DigitVector result(na + nb, 0);
+    mulSchoolbookInto(result.data(), a, na, b, nb);
+    return result;
+}
+
+void BigNum::addShifted(DigitVector &r, size_t offset, const int *p, size_t np)
+{
+    int carry = 0;
+    for (size_t i = 0; i < np; i++)
+    {
+        int v = r[offset + i] + p[i] + carry;
+        carry = v >= 10;
+        r[offset + i] = v - 10 * carry;
+    }
+    for (size_t k = offset + np; carry; k++)
+    {
+        int v = r[k] + 1;
+        carry = v >= 10;
+        r[k] = v - 10 * carry;
+    }
+}
+
+void BigNum::subInPlace(DigitVector &r, const DigitVector &p)
+{
+    int borrow = 0;
+    for (size_t i = 0; i < r.size() && (i < p.size() || borrow); i++)
+    {
+        int v = r[i] - borrow - (i < p.size() ? p[i] : 0);
+        borrow = v < 0;
+        r[i] = v + 10 * borrow;
+    }
+}
+
+void BigNum::trimZeros(DigitVector &d)
+{
+    while (d.size() > 1 && d.back() == 0)
+        d.pop_back();
+}
+
+DigitVector BigNum::mulKaratsuba(const int *a, size_t na, const int *b, size_t nb)
+{
+    if (na < nb)
+    {
+        swap(a, b);
+        swap(na, nb);
+    }
+
+    DigitVector result(na + nb, 0);
+
+    // Unbalanced operands: multiply b by nb-sized slices of a
+    if (2 * nb <= na)
+    {
+        for (size_t offset = 0; offset < na; offset += nb)
+        {
+            DigitVector part = mulMagnitude(a + offset, min(nb, na - offset), b, nb);
+            trimZeros(part);
+            addShifted(result, offset, part.data(), part.size());
+        }
+        return result;
+    }
+
+    size_t half = na / 2;
+    DigitVector z0 = mulMagnitude(a, half, b, half);
+    DigitVector z2 = mulMagnitude(a + half, na - half, b + half, nb - half);
+
+    DigitVector sa(na - half + 1, 0), sb(na - half + 1, 0);
+    addShifted(sa, 0, a + half, na - half);
+    addShifted(sa, 0, a, half);
+    addShifted(sb, 0, b + half, nb - half);
+    addShifted(sb, 0, b, half);
+    trimZeros(sa);
+    trimZeros(sb);
+
+    DigitVector z1 = mulMagnitude(sa.data(), sa.size(), sb.data(), sb.size());
+    subInPlace(z1, z0);
+    subInPlace(z1, z2);
+
+    trimZeros(z0);
+    trimZeros(z1);
+    trimZeros(z2);
+    addShifted(result, 0, z0.data(), z0.size());
+    addShifted(result, half, z1.data(), z1.size());
+    addShifted(result, 2 * half, z2.data(), z2.size());
+    return result;
+}
+
+DigitVector BigNum::mulMagnitude(const int *a, size_t na, const int *b, size_t nb)
+{
+    if (min(na, nb) < tuningStorage().karatsubaThreshold)
+    {
+        return mulSchoolbook(a, na, b, nb);
+    }
+    return mulKaratsuba(a, na, b, nb);
+}
+
+DigitVector BigNum::mulShort(const int *a, size_t na, const int *b, size_t nb, size_t skip)
+{
+    DigitVector result(na + nb, 0);
+
+    // Digits whose products all land below skip are dropped outright
+    size_t dropA = skip + 1 > nb ? min(na, skip + 1 - nb) : 0;
+    if (dropA == na)
+        return result;
+    a += dropA;
+    na -= dropA;
+    skip -= dropA;
+    size_t dropB = skip + 1 > na ? min(nb, skip + 1 - na) : 0;
+    if (dropB == nb)
+        return result;
+    b += dropB;
+    nb -= dropB;
+    skip -= dropB;
+    const size_t offset = dropA + dropB;
+
+    // Any k <= ceil(skip / 2) keeps the low parts' products below skip;
+    // about 0.3 skip is Mulders' best split for Karatsuba, ~0.8 of a full product
+    const size_t k = max<size_t>(1, 3 * (skip + 1) / 10);
+    if (skip > 0 && min(na, nb) < tuningStorage().karatsubaThreshold)
+    {
+        // Schoolbook restricted to the columns at or above skip
+        int *r = &result[offset];
+        for (size_t i = 0; i < na; i++)
+        {
+            size_t j = skip > i ? skip - i : 0;
+            if (a[i] != 0 && j < nb)
+                mulAddRow(r + i + j, b + j, nb - j, a[i]);
+            if ((i + 1) % SCHOOLBOOK_CARRY_INTERVAL == 0)
+                propagateCarries(r, result.size() - offset);
+        }
+        propagateCarries(r, result.size() - offset);
+    }
+    else if (skip == 0 || k >= min(na, nb))
+    {
+        DigitVector full = mulMagnitude(a, na, b, nb);
+        trimZeros(full);
+        addShifted(result, offset, full.data(), full.size());
+    }
+    else
+    {
+        DigitVector high = mulMagnitude(a + k, na - k, b + k, nb - k);
+        DigitVector cross1 = mulShort(a + k, na - k, b, k, skip - k);
+        DigitVector cross2 = mulShort(a, k, b + k, nb - k, skip - k);
+        trimZeros(high);
+        trimZeros(cross1);
+        trimZeros(cross2);
+        addShifted(result, offset + 2 * k, high.data(), high.size());
+        addShifted(result, offset + k, cross1.data(), cross1.size());
+        addShifted(result, offset + k, cross2.data(), cross2.size());
+    }
+    return result;
+}
+
+vector<uint8_t> BigNum::toBytesMagnitude(const int *d, size_t n)
+{
+    vector<uint32_t> words;
+    for (size_t start = 0; start < n; start += 9)
+    {
+        uint32_t word = 0;
+        for (size_t i = min(n, start + 9); i-- > start;)
+        {
+            word = word * 10 + d[i];
+        }
+        words.push_back(word);
+    }
+    reverse(words.begin(), words.end()); // most significant first
+
+    vector<uint8_t> bytes; // least significant first
+    size_t first = 0;
+    while (first < words.size())
+    {
+        uint64_t rem = 0;
+        for (size_t i = first; i < words.size(); i++)
+        {
+            uint64_t cur = rem * 1000000000ULL + words[i];
+            words[i] = (uint32_t)(cur >> 32);
+            rem = cur & 0xFFFFFFFFULL;
+        }
+        for (int k = 0; k < 4; k++)
+        {
+            bytes.push_back((rem >> (8 * k)) & 0xFF);
+        }
+        while (first < words.size() && words[first] == 0)
+            first++;
+    }
+
+    while (!bytes.empty() && bytes.back() == 0)
+        bytes.pop_back();
+    reverse(bytes.begin(), bytes.end());
+    return bytes;
+}
+
+int BigNum::digitValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A' + 10;
+    return -1;
+}
+
+void BigNum::checkRadix(int radix)
+{
+    if (radix < 2 || radix > 36)
+    {
+        throw runtime_error("Radix must be between 2 and 36");
+    }
+}
+
+int BigNum::chunkDigits(int radix, long long *power)
+{
+    int count = 0;
+    long long value = 1;
+    while (value <= LLONG_MAX / radix)
+    {
+        value *= radix;
+        count++;
+    }
+    if (power)
+        *power = value;
+    return count;
+}
+
+long long BigNum::toLongLong() const
+{
+    long long value = 0;
+    for (int i = digits.size() - 1; i >= 0; i--)
+    {
+        value = value * 10 + digits[i];
+    }
+    return value;
+}
+
+template <typename Body>
+void BigNum::parallelFor(size_t n, size_t minChunk, Body body)
+{
+    size_t threads = max(1u, thread::hardware_concurrency());
+    threads = min(threads, max<size_t>(1, n / minChunk));
+    if (threads <= 1)
+    {
+        body(0, n);
+        return;
+    }
+
+    vector<thread> pool;
+    size_t step = (n + threads - 1) / threads;
+    for (size_t from = step; from < n; from += step)
+    {
+        pool.emplace_back(body, from, min(n, from + step));
+    }
+    body(0, min(n, step));
+    for (thread &t : pool)
+    {
+        t.join();
+    }
+}
+
+int BigNum::parallelDepth()
+{
+    int depth = 0;
+    for (unsigned threads = thread::hardware_concurrency(); threads > 1; threads >>= 1)
+        depth++;
+    return depth;
+}
+
+BigNum BigNum::parseRadix(const char *p, size_t len, int radix, int chunk,
+                          const vector<BigNum> &powers, int depth)
+{
+    if (len <= (size_t)chunk)
+    {
+        long long value = 0;
+        for (size_t i = 0; i < len; i++)
+        {
+            int d = digitValue(p[i]);
+            if (d < 0 || d >= radix)
+            {
+                throw runtime_error("Invalid digit for radix " + to_string(radix));
+            }
+            value = value * radix + d;
+        }
+        return BigNum(value);
+    }
+
+    int k = 0;
+    while (((size_t)chunk << (k + 1)) < len)
+        k++;
+    size_t lowLen = (size_t)chunk << k;
+
+    if (depth > 0)
+    {
+        future<BigNum> high = async(launch::async, parseRadix, p, len - lowLen, radix, chunk,
+                                    cref(powers), depth - 1);
+        BigNum low = parseRadix(p + len - lowLen, lowLen, radix, chunk, powers, depth - 1);
+        return high.get() * powers[k] + low;
+    }
+    return parseRadix(p, len - lowLen, radix, chunk, powers, 0) * powers[k] +
+           parseRadix(p + len - lowLen, lowLen, radix, chunk, powers, 0);
+}
+
+string BigNum::emitRadix(const BigNum &value, int level, size_t pad, int radix, int chunk,
+                         const vector<BigNum> &powers, int depth)
+{
+    if (level == 0)
+    {
+        string text;
+        for (long long v = value.toLongLong(); v > 0; v /= radix)
+        {
+            text += "0123456789abcdefghijklmnopqrstuvwxyz"[v % radix];
+        }
+        if (text.size() < pad)
+            text.append(pad - text.size(), '0');
+        reverse(text.begin(), text.end());
+        return text;
+    }
+
+    const BigNum &divisor = powers[level - 1];
+    size_t lowWidth = (size_t)chunk << (level - 1);
+    BigNum high = value / divisor;
+    BigNum low = value - high * divisor;
+    size_t highPad = pad > lowWidth ? pad - lowWidth : 0;
+
+    if (depth > 0)
+    {
+        future<string> highText = async(launch::async, emitRadix, cref(high), level - 1, highPad,
+                                        radix, chunk, cref(powers), depth - 1);
+        string lowText = emitRadix(low, level - 1, lowWidth, radix, chunk, powers, depth - 1);
+        return highText.get() + lowText;
+    }
+    return emitRadix(high, level - 1, highPad, radix, chunk, powers, 0) +
+           emitRadix(low, level - 1, lowWidth, radix, chunk, powers, 0);
+}
+
+BigNumStats BigNum::stats()
+{
+#ifdef BIGNUM_STATS
+    return BigNumStatsRegistry::instance().merged();
+#else
+    return BigNumStats();
+#endif
+}
+
+void BigNum::resetStats()
+{
+#ifdef BIGNUM_STATS
+    BigNumStatsRegistry::instance().reset();
+#endif
+}
+
+void BigNum::dumpStats(ostream &os)
+{
+    stats().dump(os);
+}
+
+const BigNumTuning &BigNum::tuning()
+{
+    return tuningStorage();
+}
+
+void BigNum::setTuning(const BigNumTuning &settings)
+{
+    tuningStorage() = settings;
+    tuningStorage().karatsubaThreshold = max<size_t>(4, settings.karatsubaThreshold);
+}
+
+BigNumAllocationCount BigNum::threadAllocations()
+{
+    return BigNumAllocationTracker::local();
+}
+
+BigNumAllocationHook BigNum::setAllocationHook(BigNumAllocationHook hook)
+{
+    return BigNumAllocationTracker::hook().exchange(hook);
+}
+
+BigNum::BigNum() : is_negative(false)
+{
+    digits.push_back(0);
+}
+
+BigNum::BigNum(const string &str) : is_negative(false)
+{
+    assignText(str.begin(), str.end());
+}
+
+#if BIGNUM_HAVE_STRING_VIEW
+BigNum::BigNum(string_view str) : is_negative(false)
+{
+    assignText(str.begin(), str.end());
+}
+#endif
+
+BigNum::BigNum(long long num) : is_negative(num < 0)
+{
+    if (num < 0)
+        num = -num;
+
+    if (num == 0)
+    {
+        digits.push_back(0);
+        is_negative = false;
+    }
+    else
+    {
+        while (num > 0)
+        {
+            digits.push_back(num % 10);
+            num /= 10;
+        }
+    }
+}
+
+BigNum &BigNum::operator=(const BigNum &other)
+{
+    if (this != &other)
+    {
+        digits = other.digits;
+        is_negative = other.is_negative;
+    }
+    return *this;
+}
+
+bool BigNum::operator==(const BigNum &other) const
+{
+    return is_negative == other.is_negative &&
+           compareMagnitude(digitData(), digitCount(), other.digitData(), other.digitCount()) == 0;
+}
+
+bool BigNum::operator<(const BigNum &other) const
+{
+    if (is_negative != other.is_negative)
+    {
+        return is_negative;
+    }
+
+    int cmp = compareMagnitude(digitData(), digitCount(), other.digitData(), other.digitCount());
+    return is_negative ? cmp > 0 : cmp < 0;
+}
+
+BigNum BigNum::operator-() const
+{
+    BigNum result(*this);
+    if (!result.isZero())
+    {
+        result.is_negative = !result.is_negative;
+    }
+    return result;
+}
+
+void BigNum::addSigned(BigNum &r, const BigNum &a, const BigNum &b, bool negateB)
+{
+    const size_t na = a.digitCount(), nb = b.digitCount();
+    const bool aNegative = a.is_negative, bNegative = b.is_negative != negateB;
+
+    if (aNegative == bNegative)
+    {
+        // Same sign: add magnitudes. Resizing r first keeps a and b readable
+        // when r is one of them, since only digits past na or nb change.
+        const size_t n = max(na, nb);
+        r.digits.resize(n);
+        const int *pa = a.digitData(), *pb = b.digitData();
+        int *pr = r.digits.data();
+
+        int carry = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            int sum = (i < na ? pa[i] : 0) + (i < nb ? pb[i] : 0) + carry;
+            carry = sum >= 10;
+            pr[i] = carry ? sum - 10 : sum;
+        }
+        if (carry)
+            r.digits.push_back(1);
+        r.is_negative = aNegative && !r.isZero();
+        return;
+    }
+
+    // Opposite signs: subtract the smaller magnitude from the larger, which
+    // gives the result its sign
+    int cmp = compareMagnitude(a.digitData(), na, b.digitData(), nb);
+    if (cmp == 0)
+    {
+        r.digits.assign(1, 0);
+        r.is_negative = false;
+        return;
+    }
+    const BigNum &larger = cmp > 0 ? a : b, &smaller = cmp > 0 ? b : a;
+    const size_t nl = cmp > 0 ? na : nb, ns = cmp > 0 ? nb : na;
+    const bool negative = cmp > 0 ? aNegative : bNegative;
+
+    r.digits.resize(nl);
+    const int *pl = larger.digitData(), *ps = smaller.digitData();
+    int *pr = r.digits.data();
+
+    int borrow = 0;
+    for (size_t i = 0; i < nl; i++)
+    {
+        int diff = pl[i] - (i < ns ? ps[i] : 0) - borrow;
+        borrow = diff < 0;
+        pr[i] = borrow ? diff + 10 : diff;
+    }
+    r.removeLeadingZeros();
+    r.is_negative = negative;
+}
+
+BigNum BigNum::operator+(const BigNum &other) const
+{
+    BigNum result(Capacity{max(digits.size(), other.digits.size()) + 1});
+    addSigned(result, *this, other, false);
+    return result;
+}
+
+BigNum &BigNum::operator+=(const BigNum &other)
+{
+    addSigned(*this, *this, other, false);
+    return *this;
+}
+
+BigNum BigNum::operator-(const BigNum &other) const
+{
+    BigNum result(Capacity{max(digits.size(), other.digits.size()) + 1});
+    addSigned(result, *this, other, true);
+    return result;
+}
+
+BigNum &BigNum::operator-=(const BigNum &other)
+{
+    addSigned(*this, *this, other, true);
+    return *this;
+}
+
+BigNum BigNum::operator*(const BigNum &other) const
+{
+    BIGNUM_STAT_SCOPE(min(digits.size(), other.digits.size()) < tuningStorage().karatsubaThreshold
+                          ? STAT_MUL_SCHOOLBOOK
+                          : STAT_MUL_KARATSUBA,
+                      digits.size() + other.digits.size());
+    BigNum result;
+    result.digits = mulMagnitude(digitData(), digitCount(), other.digitData(), other.digitCount());
+    result.is_negative = is_negative ^ other.is_negative;
+
+    result.removeLeadingZeros();
+    if (result.isZero())
+        result.is_negative = false;
+
+    return result;
+}
+
+BigNum BigNum::operator/(const BigNum &divisor) const
+{
+    BIGNUM_STAT_SCOPE(STAT_DIVMOD, digits.size() + divisor.digits.size());
+    if (divisor.isZero())
+    {
+        throw runtime_error("Division by zero");
+    }
+
+    if (isZero())
+        return BigNum(0);
+
+    BigNum dividend(*this);
+    dividend.is_negative = false;
+    BigNum div(divisor);
+    div.is_negative = false;
+
+    if (dividend < div)
+        return BigNum(0);
+
+    BigNum quotient(0);
+    BigNum remainder(0);
+
+    for (int i = digits.size() - 1; i >= 0; i--)
+    {
+        remainder = remainder * BigNum(10) + BigNum(digits[i]);
+
+        int count = 0;
+        while (remainder >= div)
+        {
+            remainder = remainder - div;
+            count++;
+        }
+
+        quotient.digits.insert(quotient.digits.begin(), count);
+    }
+
+    quotient.removeLeadingZeros();
+    quotient.is_negative = is_negative ^ divisor.is_negative;
+    if (quotient.isZero())
+        quotient.is_negative = false;
+
+    return quotient;
+}
+
+BigNum BigNum::operator%(const BigNum &divisor) const
+{
+    BIGNUM_STAT_SCOPE(STAT_REDUCE_DIVISION, digits.size() + divisor.digits.size());
+    if (divisor.isZero())
+    {
+        throw runtime_error("Division by zero");
+    }
+
+    BigNum quotient = *this / divisor;
+    BigNum remainder = *this - quotient * divisor;
+
+    // Ensure remainder is positive for modular arithmetic
+    if (remainder.is_negative)
+    {
+        remainder = remainder + (divisor.is_negative ? -divisor : divisor);
+    }
+
+    return remainder;
+}
+
+BigNum BigNum::addMod(const BigNum &b, const BigNum &m) const
+{
+    return BigNumModContextCache::shared().recent(m).addMod(*this, b);
+}
+
+BigNum BigNum::mulMod(const BigNum &b, const BigNum &m) const
+{
+    return BigNumModContextCache::shared().recent(m).mulMod(*this, b);
+}
+
+BigNum BigNum::powMod(const BigNum &exp, const BigNum &m) const
+{
+    // The multiples table is built (or found) once and reused by every squaring
+    return BigNumModContextCache::shared().recent(m).powMod(*this, exp);
+}
+
+BigNum BigNum::powMod(const BigNum &exp, const BigNum &m, const BigNumStopToken &stop) const
+{
+    return BigNumModContextCache::shared().recent(m).powMod(*this, exp, stop);
+}
+
+BigNum BigNum::powModConstTime(const BigNum &exp, const BigNum &m) const
+{
+    return BigNumMontgomery(m).powModConstTime(*this, exp);
+}
+
+BigNum BigNum::powModLadder(const BigNum &exp, const BigNum &m) const
+{
+    return BigNumMontgomery(m).powModLadder(*this, exp);
+}
+
+BigNum BigNum::gcd(const BigNum &a, const BigNum &b)
+{
+    // Euclid on the magnitudes with no coefficients to carry. Each remainder
+    // is one pass of the context's table-driven long division, far cheaper
+    // than operator%, and replaces its dividend through a swap.
+    BigNum x = a, y = b;
+    x.is_negative = false;
+    y.is_negative = false;
+    while (!y.isZero())
+    {
+        x = BigNumModContext(y).reduce(x);
+        swap(x, y);
+    }
+    return x;
+}
+
+BigNum BigNum::extendedGCD(const BigNum &a, const BigNum &b, BigNum &x, BigNum &y)
+{
+    // Forward form of the recursion x = y1, y = x1 - (a / b) * y1: each step
+    // applies the same symmetric matrix, so the coefficients come out
+    // identical. The updates subtract in place and swap rather than building
+    // signed temporaries.
+    BigNum r0 = a, r1 = b;
+    BigNum x0(1), x1(0), y0(0), y1(1);
+    while (!r1.isZero())
+    {
+        BigNum q = r0 / r1;
+        BigNum r2 = r0 % r1;
+        x0 -= q * x1;
+        swap(x0, x1);
+        y0 -= q * y1;
+        swap(y0, y1);
+        r0 = std::move(r1);
+        r1 = std::move(r2);
+    }
+
+    x = std::move(x0);
+    y = std::move(y0);
+    return r0;
+}
+
+BigNum BigNum::modInverse(const BigNum &m) const
+{
+    return modInverse(m, BigNumStopToken());
+}
+
+BigNum BigNum::modInverse(const BigNum &m, const BigNumStopToken &stop) const
+{
+    BIGNUM_STAT_SCOPE(STAT_MODINVERSE, m.digits.size());
+    // Iterative extended Euclid tracking only the coefficient of a, so huge
+    // inputs neither recurse once per step nor run past the stop token. Each
+    // step divides, which dwarfs a token check.
+    BigNum r0 = *this % m, r1 = m;
+    r1.is_negative = false;
+    BigNum s0(1), s1(0);
+    while (!r1.isZero())
+    {
+        BigNum q = r0 / r1;
+        r0 -= q * r1;
+        swap(r0, r1);
+        s0 -= q * s1;
+        swap(s0, s1);
+        stop.throwIfStopped();
+    }
+
+    if (!r0.isOne())
+    {
+        throw runtime_error("Modular inverse does not exist");
+    }
+
+    // % lifts the coefficient into [0, |m|)
+    return s0 % m;
+}
+
+bool BigNum::isProbablePrime(int rounds) const
+{
+    return isProbablePrime(rounds, BigNumStopToken());
+}
+
+bool BigNum::isProbablePrime(int rounds, const BigNumStopToken &stop, const BigNumProgress &progress) const
+{
+    static const int smallPrimes[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41,
+                                      43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97};
+    static const int smallPrimeCount = sizeof(smallPrimes) / sizeof(smallPrimes[0]);
+
+    if (is_negative || *this < BigNum(2))
+        return false;
+
+    // Trial division settles small numbers and most composites
+    for (int p : smallPrimes)
+    {
+        BigNum prime(p);
+        if (*this == prime)
+            return true;
+        if ((*this % prime).isZero())
+            return false;
+    }
+    if (*this < BigNum(100 * 100))
+        return true;
+
+    // n - 1 = d * 2^s with d odd
+    BigNumModContext context(*this);
+    BigNum one(1), two(2);
+    BigNum nMinusOne = *this - one;
+    BigNum d = nMinusOne;
+    int s = 0;
+    while (d.digits[0] % 2 == 0)
+    {
+        d = d / two;
+        s++;
+    }
+
+    // Bases past the small primes come from a fixed LCG, reduced into [2, n - 2]
+    BigNum span = *this - BigNum(3);
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (int round = 0; round < rounds; round++)
+    {
+        BigNum base;
+        if (round < smallPrimeCount)
+        {
+            base = BigNum(smallPrimes[round]);
+        }
+        else
+        {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            base = BigNum((long long)(state >> 1)) % span + two;
+        }
+
+        BigNum x = context.powMod(base, d, stop);
+        bool witness = !x.isOne() && x != nMinusOne;
+        for (int i = 1; witness && i < s; i++)
+        {
+            x = context.mulMod(x, x);
+            if (x == nMinusOne)
+                witness = false;
+        }
+        if (witness)
+            return false;
+
+        stop.throwIfStopped();
+        if (progress)
+            progress((double)(round + 1) / rounds);
+    }
+    return true;
+}
+
+// Factors packed into words below 2^63 and multiplied as a balanced tree,
+// so that every multiplication pairs operands of about the same size
+struct FactorProduct
+{
+    vector<BigNum> words;
+    uint64_t word = 1;
+
+    static BigNum fromUnsigned(uint64_t v)
+    {
+        return v <= (uint64_t)LLONG_MAX ? BigNum((long long)v) : BigNum(to_string(v));
+    }
+
+    void push(uint64_t factor)
+    {
+        if (word > (uint64_t)LLONG_MAX / factor)
+        {
+            words.push_back(fromUnsigned(word));
+            word = factor;
+        }
+        else
+        {
+            word *= factor;
+        }
+    }
+
+    void push(uint64_t p, uint64_t exponent)
+    {
+        for (; exponent > 0; exponent--)
+        {
+            push(p);
+        }
+    }
+
+    static BigNum product(const vector<BigNum> &v, size_t lo, size_t hi)
+    {
+        if (hi - lo == 1)
+            return v[lo];
+        size_t mid = lo + (hi - lo) / 2;
+        return product(v, lo, mid) * product(v, mid, hi);
+    }
+
+    BigNum finish()
+    {
+        words.push_back(fromUnsigned(word));
+        word = 1;
+        return product(words, 0, words.size());
+    }
+};
+
+// Primes up to n by a segmented sieve over odd numbers, so only one segment
+// and the primes up to sqrt(n) are held besides the result
+static vector<uint64_t> primesUpTo(uint64_t n)
+{
+    vector<uint64_t> primes;
+    if (n < 2)
+        return primes;
+    primes.push_back(2);
+
+    uint64_t root = (uint64_t)sqrt((double)n);
+    while (root * root > n)
+        root--;
+    while ((root + 1) * (root + 1) <= n)
+        root++;
+    vector<char> small(root + 1, 0);
+    vector<uint64_t> base; // odd primes up to root
+    for (uint64_t i = 3; i <= root; i += 2)
+    {
+        if (!small[i])
+        {
+            base.push_back(i);
+            for (uint64_t j = i * i; j <= root; j += 2 * i)
+                small[j] = 1;
+        }
+    }
+
+    const uint64_t SEGMENT = 1 << 16; // even, so every segment starts odd
+    vector<char> composite(SEGMENT);
+    for (uint64_t low = 3; low <= n; low += SEGMENT)
+    {
+        uint64_t high = min(n, low + SEGMENT - 1);
+        fill(composite.begin(), composite.end(), 0);
+        for (uint64_t p : base)
+        {
+            if (p * p > high)
+                break;
+            uint64_t start = max(p * p, (low + p - 1) / p * p);
+            if (start % 2 == 0)
+                start += p;
+            for (uint64_t m = start; m <= high; m += 2 * p)
+                composite[m - low] = 1;
+        }
+        for (uint64_t m = low; m <= high; m += 2)
+        {
+            if (!composite[m - low])
+                primes.push_back(m);
+        }
+        if (high == n)
+            break;
+    }
+    return primes;
+}
+
+// Exponent of p in n! (Legendre)
+static uint64_t factorialExponent(uint64_t n, uint64_t p)
+{
+    uint64_t e = 0;
+    for (uint64_t q = n / p; q > 0; q /= p)
+        e += q;
+    return e;
+}
+
+// n! from the primes up to n: n! = ((n/2)!)^2 * swing(n), where the swing
+// n! / ((n/2)!)^2 holds each p to the power sum over i of floor(n / p^i) mod 2
+static BigNum factorialBySwing(uint64_t n, const vector<uint64_t> &primes)
+{
+    if (n < 21)
+    {
+        uint64_t f = 1;
+        for (uint64_t i = 2; i <= n; i++)
+            f *= i;
+        return FactorProduct::fromUnsigned(f);
+    }
+
+    FactorProduct swing;
+    for (uint64_t p : primes)
+    {
+        if (p > n)
+            break;
+        uint64_t e = 0;
+        for (uint64_t q = n / p; q > 0; q /= p)
+            e += q & 1;
+        swing.push(p, e);
+    }
+    BigNum half = factorialBySwing(n / 2, primes);
+    return half * half * swing.finish();
+}
+
+BigNum BigNum::factorial(uint64_t n)
+{
+    return factorialBySwing(n, primesUpTo(n));
+}
+
+BigNum BigNum::binomial(uint64_t n, uint64_t k)
+{
+    if (k > n)
+        return BigNum(0);
+    k = min(k, n - k);
+    if (k == 0)
+        return BigNum(1);
+
+    // Sieving to n costs about n steps; dividing the falling product by k!
+    // about (k log n)(k log k) digit steps. Take whichever is cheaper.
+    if ((double)k * (double)k * log10((double)n) * log10((double)k + 1) < (double)n)
+    {
+        FactorProduct falling;
+        for (uint64_t i = n - k + 1; i <= n && i != 0; i++)
+            falling.push(i);
+        BigNum numerator = falling.finish();
+        return k == 1 ? numerator : BigNumModContext(factorial(k)).divide(numerator);
+    }
+
+    // Kummer: p divides C(n, k) once per borrow when subtracting k from n in base p
+    FactorProduct result;
+    for (uint64_t p : primesUpTo(n))
+    {
+        uint64_t e = factorialExponent(n, p) - factorialExponent(k, p) - factorialExponent(n - k, p);
+        result.push(p, e);
+    }
+    return result.finish();
+}
+
+BigNum BigNum::primorial(uint64_t n)
+{
+    FactorProduct result;
+    for (uint64_t p : primesUpTo(n))
+        result.push(p);
+    return result.finish();
+}
+
+BigNum BigNum::doubleFactorial(uint64_t n)
+{
+    if (n % 2 == 0)
+    {
+        // (2m)!! = 2^m m!
+        FactorProduct twos;
+        twos.push(2, n / 2);
+        return twos.finish() * factorial(n / 2);
+    }
+
+    // (2m + 1)!! = (2m + 1)! / (2^m m!), so each odd p appears to the power
+    // of its exponent in (2m + 1)! less that in m!
+    FactorProduct result;
+    for (uint64_t p : primesUpTo(n))
+    {
+        if (p > 2)
+            result.push(p, factorialExponent(n, p) - factorialExponent(n / 2, p));
+    }
+    return result.finish();
+}
+
+int BigNum::getBitLength() const
+{
+    if (isZero())
+        return 1;
+
+    BigNum temp(*this);
+    temp.is_negative = false;
+
+    int bits = 0;
+    BigNum two(2);
+
+    while (!temp.isZero())
+    {
+        temp = temp / two;
+        bits++;
+    }
+
+    return bits;
+}
+
+string BigNum::toString() const
+{
+    string result;
+
+    if (is_negative && !isZero())
+    {
+        result += "-";
+    }
+
+    const int *d = digitData();
+    for (size_t i = digitCount(); i-- > 0;)
+    {
+        result += (d[i] + '0');
+    }
+
+    return result;
+}
+
+BigNum BigNum::fromFile(const string &path, int radix)
+{
+    checkRadix(radix);
+    MappedFile file = MappedFile::openRead(path);
+    const char *p = file.data();
+    const char *end = p + file.size();
+
+    while (p < end && isspace((unsigned char)*p))
+        p++;
+    while (end > p && isspace((unsigned char)end[-1]))
+        end--;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end)
+    {
+        throw runtime_error("No digits in file: " + path);
+    }
+
+    size_t len = end - p;
+    BigNum result;
+    if (radix == 10)
+    {
+        result.digits.resize(len);
+        atomic<bool> invalid(false);
+        parallelFor(len, 1 << 16, [&](size_t from, size_t to)
+                    {
+                        for (size_t i = from; i < to; i++)
+                        {
+                            if (p[i] < '0' || p[i] > '9')
+                            {
+                                invalid = true;
+                                return;
+                            }
+                            result.digits[len - 1 - i] = p[i] - '0';
+                        }
+                    });
+        if (invalid)
+        {
+            throw runtime_error("Invalid digit in file: " + path);
+        }
+    }
+    else
+    {
+        long long chunkPower;
+        int chunk = chunkDigits(radix, &chunkPower);
+        vector<BigNum> powers(1, BigNum(chunkPower));
+        while (((size_t)chunk << powers.size()) < len)
+        {
+            powers.push_back(powers.back() * powers.back());
+        }
+        result = parseRadix(p, len, radix, chunk, powers, parallelDepth());
+    }
+
+    result.removeLeadingZeros();
+    result.is_negative = negative && !result.isZero();
+    return result;
+}
+
+void BigNum::toFile(const string &path, int radix) const
+{
+    checkRadix(radix);
+    size_t sign = (is_negative && !isZero()) ? 1 : 0;
+
+    if (radix == 10)
+    {
+        size_t n = digitCount();
+        const int *d = digitData();
+        MappedFile file = MappedFile::create(path, sign + n + 1);
+        char *out = file.data();
+        if (sign)
+            out[0] = '-';
+        parallelFor(n, 1 << 16, [&](size_t from, size_t to)
+                    {
+                        for (size_t i = from; i < to; i++)
+                        {
+                            out[sign + i] = '0' + d[n - 1 - i];
+                        }
+                    });
+        out[sign + n] = '\n';
+        return;
+    }
+
+    BigNum magnitude(*this);
+    magnitude.is_negative = false;
+
+    long long chunkPower;
+    int chunk = chunkDigits(radix, &chunkPower);
+    vector<BigNum> powers(1, BigNum(chunkPower));
+    while (!(magnitude < powers.back()))
+    {
+        powers.push_back(powers.back() * powers.back());
+    }
+
+    // Fixed-width low halves can leave zero padding at the front
+    string text = emitRadix(magnitude, powers.size() - 1, 0, radix, chunk, powers, parallelDepth());
+    size_t first = text.find_first_not_of('0');
+    text = first == string::npos ? string("0") : text.substr(first);
+    MappedFile file = MappedFile::create(path, sign + text.size() + 1);
+    char *out = file.data();
+    if (sign)
+        out[0] = '-';
+    memcpy(out + sign, text.data(), text.size());
+    out[sign + text.size()] = '\n';
+}
+
+vector<uint8_t> BigNum::toBytes() const
+{
+    return toBytesMagnitude(digitData(), digitCount());
+}
+
+BigNum BigNum::fromBytes(const uint8_t *data, size_t len)
+{
+    vector<uint32_t> words; // base 10^9, least significant first
+    size_t i = 0;
+    size_t head = len % 4;
+    while (i < len)
+    {
+        size_t take = (i == 0 && head) ? head : 4;
+        uint64_t carry = 0;
+        for (size_t k = 0; k < take; k++)
+        {
+            carry = (carry << 8) | data[i + k];
+        }
+        i += take;
+
+        for (size_t w = 0; w < words.size(); w++)
+        {
+            uint64_t cur = ((uint64_t)words[w] << (8 * take)) + carry;
+            words[w] = cur % 1000000000ULL;
+            carry = cur / 1000000000ULL;
+        }
+        while (carry)
+        {
+            words.push_back(carry % 1000000000ULL);
+            carry /= 1000000000ULL;
+        }
+    }
+
+    BigNum result;
+    result.digits.clear();
+    for (uint32_t word : words)
+    {
+        for (int k = 0; k < 9; k++)
+        {
+            result.digits.push_back(word % 10);
+            word /= 10;
+        }
+    }
+    if (result.digits.empty())
+        result.digits.push_back(0);
+    result.removeLeadingZeros();
+    return result;
+}
+
+void BigNum::print() const
+{
+    cout << toString() << endl;
+}
+
+ostream &operator<<(ostream &os, const BigNum &num)
+{
+    os << num.toString();
+    return os;
+}
+
+// Input operator: reads one whitespace-delimited token straight from the stream buffer
+istream &operator>>(istream &is, BigNum &num)
+{
+    istream::sentry guard(is); // skips leading whitespace
+    if (!guard)
+        return is;
+
+    BigNumParser parser;
+    streambuf *buf = is.rdbuf();
+    bool any = false;
+    while (true)
+    {
+        int c = buf->sgetc();
+        if (c == char_traits<char>::eof())
+        {
+            is.setstate(ios::eofbit);
+            break;
+        }
+        if (isspace(c))
+            break;
+        parser.feed((char)c);
+        buf->sbumpc();
+        any = true;
+    }
+
+    if (!any)
+    {
+        is.setstate(ios::failbit);
+        return is;
+    }
+    num = parser.finish();
+    return is;
+}
+
+void BigNumParser::feed(char c)
+{
+    if (!started)
+    {
+        started = true;
+        if (c == '-')
+        {
+            negative = true;
+            return;
+        }
+    }
+    if (c >= '0' && c <= '9')
+    {
+        pending.push_back(c - '0');
+    }
+}
+
+void BigNumParser::feed(const char *data, size_t len)
+{
+    if (len == 0)
+        return;
+    if (!started)
+    {
+        feed(*data++);
+        len--;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        if (data[i] >= '0' && data[i] <= '9')
+        {
+            pending.push_back(data[i] - '0');
+        }
+    }
+}
+
+#if BIGNUM_HAVE_STRING_VIEW
+void BigNumParser::feed(string_view chunk)
+{
+    feed(chunk.data(), chunk.size());
+}
+#endif
+
+size_t BigNumParser::digitCount() const
+{
+    return pending.size();
+}
+
+BigNum BigNumParser::finish()
+{
+    BigNum result;
+    if (!pending.empty())
+    {
+        reverse(pending.begin(), pending.end());
+        result.digits.swap(pending);
+        result.removeLeadingZeros();
+        result.is_negative = negative && !result.isZero();
+    }
+
+    pending.clear();
+    negative = false;
+    started = false;
+    return result;
+}
+
+int BigNumView::compare(const BigNumView &other) const
+{
+    if (negative != other.negative)
+        return negative ? -1 : 1;
+    int c = BigNum::compareMagnitude(limbs, length, other.limbs, other.length);
+    return negative ? -c : c;
+}
+
+vector<uint8_t> BigNumView::toBytes() const
+{
+    return BigNum::toBytesMagnitude(limbs, length);
+}
+
+BigNum BigNumView::toBigNum() const
+{
+    BigNum result;
+    result.digits.assign(limbs, limbs + length);
+    result.is_negative = negative;
+    return result;
+}
+
+string BigNumView::toString() const
+{
+    string result;
+    if (negative)
+        result += '-';
+    for (size_t i = length; i-- > 0;)
+    {
+        result += (char)('0' + limbs[i]);
+    }
+    return result;
+}
+
+ostream &operator<<(ostream &os, const BigNumView &view)
+{
+    os << view.toString();
+    return os;
+}
+
+BigNum BigNum::mulMod(const BigNumView &a, const BigNumView &b, const BigNum &m)
+{
+    return BigNumModContextCache::shared().recent(m).mulMod(a, b);
+}
+
+BigNumModContext::BigNumModContext(const BigNum &m) : modulus_(m), multiples(10)
+{
+    if (m.isZero())
+        throw runtime_error("Division by zero");
+    modulus_.is_negative = false;
+
+    const DigitVector &d = modulus_.digits;
+    multiples[0].assign(1, 0);
+    for (int q = 1; q < 10; q++)
+    {
+        multiples[q].resize(d.size() + 1);
+        int carry = 0;
+        for (size_t i = 0; i < d.size(); i++)
+        {
+            int v = d[i] * q + carry;
+            carry = v / 10;
+            multiples[q][i] = v - 10 * carry;
+        }
+        multiples[q][d.size()] = carry;
+        BigNum::trimZeros(multiples[q]);
+    }
+}
+
+size_t BigNumModContext::byteLength() const
+{
+    return max<size_t>(1, modulus_.toBytes().size());
+}
+
+int BigNumModContext::quotientDigit(const int *rem, size_t n) const
+{
+    int lo = 0, hi = 9;
+    while (lo < hi)
+    {
+        int mid = (lo + hi + 1) / 2;
+        const DigitVector &p = multiples[mid];
+        if (BigNum::compareMagnitude(p.data(), p.size(), rem, n) <= 0)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    return lo;
+}
+
+void BigNumModContext::reduceMagnitude(const int *x, size_t n, DigitVector &rem, DigitVector *quotient) const
+{
+    BIGNUM_STAT_SCOPE(STAT_REDUCE_CONTEXT, n);
+    const size_t k = modulus_.digits.size();
+    rem.reserve(k + 1);
+    if (BigNum::compareMagnitude(x, n, modulus_.digits.data(), k) < 0)
+    {
+        rem.assign(x, x + n);
+        if (quotient)
+            quotient->assign(1, 0);
+        return;
+    }
+
+    // The top k - 1 digits are below |m|; bring the rest down one at a time
+    size_t i = n - (k - 1);
+    rem.assign(x + i, x + n);
+    if (rem.empty())
+        rem.push_back(0);
+    if (quotient)
+        quotient->assign(i, 0); // filled from the top as digits come down
+    while (i-- > 0)
+    {
+        if (rem.size() == 1 && rem[0] == 0)
+            rem[0] = x[i];
+        else
+            rem.insert(rem.begin(), x[i]);
+
+        if (rem.size() < k)
+            continue;
+
+        int q = quotientDigit(rem.data(), rem.size());
+        if (q > 0)
+        {
+            BigNum::subInPlace(rem, multiples[q]);
+            BigNum::trimZeros(rem);
+            if (quotient)
+                (*quotient)[i] = q;
+        }
+    }
+    if (quotient)
+        BigNum::trimZeros(*quotient);
+}
+
+BigNum BigNumModContext::finish(DigitVector &rem, bool negative) const
+{
+    BigNum result;
+    if (negative && !(rem.size() == 1 && rem[0] == 0))
+    {
+        // Lift a negative remainder into [0, |m|), as operator% does
+        DigitVector lifted(modulus_.digits);
+        BigNum::subInPlace(lifted, rem);
+        BigNum::trimZeros(lifted);
+        rem.swap(lifted);
+    }
+    result.digits.swap(rem);
+    return result;
+}
+
+BigNum BigNumModContext::reduce(const BigNum &x) const
+{
+    DigitVector rem;
+    reduceMagnitude(x.digitData(), x.digitCount(), rem);
+    return finish(rem, x.is_negative);
+}
+
+BigNum BigNumModContext::divide(const BigNum &x) const
+{
+    DigitVector rem;
+    BigNum q;
+    reduceMagnitude(x.digitData(), x.digitCount(), rem, &q.digits);
+    q.is_negative = x.is_negative && !q.isZero();
+    return q;
+}
+
+BigNum BigNumModContext::addMod(const BigNum &a, const BigNum &b) const
+{
+    BIGNUM_STAT_SCOPE(STAT_ADDMOD, modulus_.digits.size());
+    return reduce(a + b);
+}
+
+BigNum BigNumModContext::mulMod(const BigNumView &a, const BigNumView &b) const
+{
+    BIGNUM_STAT_SCOPE(STAT_MULMOD, modulus_.digits.size());
+    DigitVector product = BigNum::mulMagnitude(a.data(), a.size(), b.data(), b.size());
+    BigNum::trimZeros(product);
+    DigitVector rem;
+    reduceMagnitude(product.data(), product.size(), rem);
+    return finish(rem, a.isNegative() ^ b.isNegative());
+}
+
+void BigNumModContext::mulMod(const BigNumView &a, const BigNumView &b, BigNum &out) const
+{
+    const size_t na = a.size(), nb = b.size();
+    if (a.data() == out.digits.data() || b.data() == out.digits.data() || out.digits.capacity() < na + nb)
+    {
+        out = mulMod(a, b);
+        return;
+    }
+
+    BIGNUM_STAT_SCOPE(STAT_MULMOD, modulus_.digits.size());
+    DigitVector &r = out.digits;
+    r.assign(na + nb, 0);
+    mulSchoolbookInto(r.data(), a.data(), na, b.data(), nb);
+    BigNum::trimZeros(r);
+
+    // Long division in place: the remainder is the window r[i, top), which
+    // takes in the next digit below by moving i down instead of shifting
+    const int *m = modulus_.digits.data();
+    const size_t k = modulus_.digits.size();
+    size_t top = r.size();
+    if (BigNum::compareMagnitude(r.data(), top, m, k) >= 0)
+    {
+        for (size_t i = top - (k - 1); i-- > 0;)
+        {
+            while (top > i + 1 && r[top - 1] == 0)
+                top--;
+            if (top - i < k)
+                continue;
+
+            int q = quotientDigit(&r[i], top - i);
+            if (q > 0)
+            {
+                const DigitVector &p = multiples[q];
+                int borrow = 0;
+                for (size_t j = 0; i + j < top; j++)
+                {
+                    int v = r[i + j] - borrow - (j < p.size() ? p[j] : 0);
+                    borrow = v < 0;
+                    r[i + j] = v + 10 * borrow;
+                }
+            }
+        }
+        r.resize(top);
+        BigNum::trimZeros(r);
+    }
+
+    // Lift a negative product into [0, |m|) in place, as finish() does
+    if (a.isNegative() != b.isNegative() && (r.size() > 1 || r[0] != 0))
+    {
+        r.resize(k, 0);
+        int borrow = 0;
+        for (size_t j = 0; j < k; j++)
+        {
+            int v = m[j] - r[j] - borrow;
+            borrow = v < 0;
+            r[j] = v + 10 * borrow;
+        }
+        BigNum::trimZeros(r);
+    }
+    out.is_negative = false;
+}
+
+BigNum BigNumModContext::powMod(const BigNum &base, const BigNum &exp) const
+{
+    return powMod(base, exp, BigNumStopToken());
+}
+
+BigNum BigNumModContext::powMod(const BigNum &base, const BigNum &exp, const BigNumStopToken &stop,
+                                const BigNumProgress &progress) const
+{
+    BIGNUM_STAT_SCOPE(STAT_POWMOD_WINDOW1, modulus_.digits.size());
+    BigNum result = reduce(BigNum(1));
+    BigNum power = reduce(base);
+
+    // Right-to-left binary method over the exponent's bits
+    vector<uint8_t> bits = exp.toBytes();
+    for (size_t i = bits.size(); i-- > 0;)
+    {
+        for (int bit = 0; bit < 8; bit++)
+        {
+            if ((bits[i] >> bit) & 1)
+                result = mulMod(result, power);
+            if (i > 0 || (bits[i] >> bit) > 1)
+                power = mulMod(power, power);
+            stop.throwIfStopped();
+        }
+        if (progress)
+            progress((double)(bits.size() - i) / bits.size());
+    }
+    return result;
+}
+
+void BigNumModContext::powModBatch(const BigNum *bases, const BigNum *exps, BigNum *results, size_t count) const
+{
+    mutex errorLock;
+    exception_ptr error;
+    BigNum::parallelFor(count, 1, [&](size_t from, size_t to)
+                        {
+                            try
+                            {
+                                for (size_t i = from; i < to; i++)
+                                {
+                                    results[i] = powMod(bases[i], exps[i]);
+                                }
+                            }
+                            catch (...)
+                            {
+                                lock_guard<mutex> lock(errorLock);
+                                if (!error)
+                                    error = current_exception();
+                            }
+                        });
+    if (error)
+        rethrow_exception(error);
+}
+
+// All ones if a == b, else zero, without a branch
+template <typename Limb>
+static inline Limb equalMask(Limb a, Limb b)
+{
+    Limb d = a ^ b;
+    return (Limb)(((d | (Limb)(0 - d)) >> (8 * sizeof(Limb) - 1)) - 1);
+}
+
+// Swap a and b if swap is 1, leave them if it is 0
+template <typename Limb>
+static inline void conditionalSwap(Limb *a, Limb *b, size_t n, Limb swap)
+{
+    Limb mask = 0 - swap;
+    for (size_t i = 0; i < n; i++)
+    {
+        Limb x = mask & (a[i] ^ b[i]);
+        a[i] ^= x;
+        b[i] ^= x;
+    }
+}
+
+BigNumMontgomery::BigNumMontgomery(const BigNum &m) : modulus_(m)
+{
+    if (m.digitData()[0] % 2 == 0)
+        throw runtime_error("Montgomery modulus must be odd");
+    modulus_.is_negative = false;
+    limbs = toLimbs(modulus_);
+    size_t n = limbs.size();
+
+    // Newton's iteration for m0^-1 doubles the correct low bits each step,
+    // starting from 3 (m0 * m0 = 1 mod 8 for odd m0)
+    Limb x = limbs[0];
+    for (int i = 0; i < 5; i++)
+    {
+        x *= (Limb)(2 - limbs[0] * x);
+    }
+    inverse = (Limb)(0 - x);
+
+    // R mod m and R^2 mod m by repeated doubling of 1 mod m; the modulus is
+    // public, so this only has to be correct
+    vector<Limb> v(n, 0), u(n);
+    v[0] = (n == 1 && limbs[0] == 1) ? 0 : 1;
+    for (size_t step = 0; step < 2 * n * LIMB_BITS; step++)
+    {
+        Limb carry = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            Limb top = v[i] >> (LIMB_BITS - 1);
+            v[i] = (Limb)(v[i] << 1) | carry;
+            carry = top;
+        }
+        Limb borrow = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            Wide d = (Wide)v[i] - limbs[i] - borrow;
+            u[i] = (Limb)d;
+            borrow = (Limb)(d >> LIMB_BITS) & 1;
+        }
+        if (carry || !borrow)
+            v.swap(u);
+        if (step + 1 == n * LIMB_BITS)
+            unity = v;
+    }
+    rr = v;
+}
+
+vector<BigNumMontgomery::Limb> BigNumMontgomery::toLimbs(const BigNum &x)
+{
+    vector<uint8_t> bytes = x.toBytes();
+    const size_t size = sizeof(Limb);
+    vector<Limb> out(max<size_t>(1, (bytes.size() + size - 1) / size), 0);
+    for (size_t i = 0; i < bytes.size(); i++)
+    {
+        size_t k = bytes.size() - 1 - i; // byte significance
+        out[k / size] |= (Limb)bytes[i] << (8 * (k % size));
+    }
+    return out;
+}
+
+vector<BigNumMontgomery::Limb> BigNumMontgomery::fixedLimbs(const BigNum &x, size_t width)
+{
+    // d decimal digits fit in d * log2(10) + 1 bits; 3.321929 bounds log2(10)
+    // from above
+    const size_t count = x.digitCount();
+    width = max(width, (size_t)(((uint64_t)count * 3321929 / 1000000 + LIMB_BITS) / LIMB_BITS));
+    vector<Limb> out(width, 0);
+
+    // Horner's rule from the top digit, carrying through every limb each time
+    const int *d = x.digitData();
+    for (size_t i = count; i-- > 0;)
+    {
+        Limb carry = (Limb)d[i];
+        for (size_t j = 0; j < width; j++)
+        {
+            Wide v = (Wide)out[j] * 10 + carry;
+            out[j] = (Limb)v;
+            carry = (Limb)(v >> LIMB_BITS);
+        }
+    }
+    return out;
+}
+
+void BigNumMontgomery::multiply(Limb *r, const Limb *a, const Limb *b, Limb *t) const
+{
+    const size_t n = limbs.size();
+    const Limb *m = limbs.data();
+    for (size_t j = 0; j < n + 2; j++)
+    {
+        t[j] = 0;
+    }
+
+    // Interleaved (CIOS): add a * b[i], then cancel the low word with a multiple of m and shift
+    for (size_t i = 0; i < n; i++)
+    {
+        Limb carry = 0;
+        for (size_t j = 0; j < n; j++)
+        {
+            Wide s = (Wide)a[j] * b[i] + t[j] + carry;
+            t[j] = (Limb)s;
+            carry = (Limb)(s >> LIMB_BITS);
+        }
+        Wide s = (Wide)t[n] + carry;
+        t[n] = (Limb)s;
+        t[n + 1] = (Limb)(s >> LIMB_BITS);
+
+        Limb q = t[0] * inverse;
+        s = (Wide)q * m[0] + t[0];
+        carry = (Limb)(s >> LIMB_BITS);
+        for (size_t j = 1; j < n; j++)
+        {
+            s = (Wide)q * m[j] + t[j] + carry;
+            t[j - 1] = (Limb)s;
+            carry = (Limb)(s >> LIMB_BITS);
+        }
+        s = (Wide)t[n] + carry;
+        t[n - 1] = (Limb)s;
+        t[n] = t[n + 1] + (Limb)(s >> LIMB_BITS);
+    }
+
+    // t < 2m: form t - m in r, then keep t instead if the subtraction borrowed
+    // past the top word
+    Limb borrow = 0;
+    for (size_t j = 0; j < n; j++)
+    {
+        Wide d = (Wide)t[j] - m[j] - borrow;
+        r[j] = (Limb)d;
+        borrow = (Limb)(d >> LIMB_BITS) & 1;
+    }
+    Limb keep = 0 - (borrow & (t[n] ^ 1));
+    for (size_t j = 0; j < n; j++)
+    {
+        r[j] = (t[j] & keep) | (r[j] & ~keep);
+    }
+}
+
+vector<BigNumMontgomery::Limb> BigNumMontgomery::enter(const BigNum &base) const
+{
+    const size_t n = limbs.size();
+    vector<Limb> x = fixedLimbs(base, n);
+    if (base.is_negative || x.size() > n)
+        x = fixedLimbs(base % modulus_, n);
+    x.resize(n, 0);
+
+    vector<Limb> t(n + 2);
+    multiply(x.data(), x.data(), rr.data(), t.data());
+    return x;
+}
+
+BigNum BigNumMontgomery::leave(const Limb *x, Limb *t) const
+{
+    const size_t n = limbs.size();
+    vector<Limb> one(n, 0), r(n);
+    one[0] = 1;
+    multiply(r.data(), x, one.data(), t);
+
+    vector<uint8_t> bytes(n * sizeof(Limb));
+    for (size_t k = 0; k < bytes.size(); k++)
+    {
+        bytes[bytes.size() - 1 - k] = (uint8_t)(r[k / sizeof(Limb)] >> (8 * (k % sizeof(Limb))));
+    }
+    return BigNum::fromBytes(bytes.data(), bytes.size());
+}
+
+BigNum BigNumMontgomery::powModConstTime(const BigNum &base, const BigNum &exp) const
+{
+    BIGNUM_STAT_SCOPE(STAT_POWMOD_CONSTTIME, modulus_.digits.size());
+    const size_t n = limbs.size();
+    vector<Limb> x = enter(base), e = fixedLimbs(exp, n);
+    vector<Limb> table(TABLE_SIZE * n), entry(unity), acc(unity), t(n + 2);
+
+    // Scatter x^k so that limb i of every entry shares a run of TABLE_SIZE words
+    for (int k = 0; k < TABLE_SIZE; k++)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            table[i * TABLE_SIZE + k] = entry[i];
+        }
+        if (k + 1 < TABLE_SIZE)
+            multiply(entry.data(), entry.data(), x.data(), t.data());
+    }
+
+    // Every window of every exponent limb, leading zeros included
+    const size_t bits = e.size() * LIMB_BITS;
+    Limb masks[TABLE_SIZE];
+    for (size_t w = (bits + WINDOW_BITS - 1) / WINDOW_BITS; w-- > 0;)
+    {
+        for (int i = 0; i < WINDOW_BITS; i++)
+        {
+            multiply(acc.data(), acc.data(), acc.data(), t.data());
+        }
+
+        Limb index = 0;
+        for (int b = 0; b < WINDOW_BITS; b++)
+        {
+            size_t bit = w * WINDOW_BITS + b;
+            if (bit < bits)
+                index |= ((e[bit / LIMB_BITS] >> (bit % LIMB_BITS)) & 1) << b;
+        }
+
+        // Gather: read every entry, keep the one at index
+        for (int k = 0; k < TABLE_SIZE; k++)
+        {
+            masks[k] = equalMask((Limb)k, index);
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            const Limb *row = &table[i * TABLE_SIZE];
+            Limb v = 0;
+            for (int k = 0; k < TABLE_SIZE; k++)
+            {
+                v |= row[k] & masks[k];
+            }
+            entry[i] = v;
+        }
+        multiply(acc.data(), acc.data(), entry.data(), t.data());
+    }
+    return leave(acc.data(), t.data());
+}
+
+BigNum BigNumMontgomery::powModLadder(const BigNum &base, const BigNum &exp) const
+{
+    BIGNUM_STAT_SCOPE(STAT_POWMOD_LADDER, modulus_.digits.size());
+    const size_t n = limbs.size();
+    vector<Limb> r0(unity), r1 = enter(base), e = fixedLimbs(exp, n), t(n + 2);
+
+    // Invariant r1 = r0 * base; consecutive swaps are merged as in x25519
+    Limb swap = 0;
+    for (size_t bit = e.size() * LIMB_BITS; bit-- > 0;)
+    {
+        Limb b = (e[bit / LIMB_BITS] >> (bit % LIMB_BITS)) & 1;
+        conditionalSwap(r0.data(), r1.data(), n, (Limb)(swap ^ b));
+        swap = b;
+        multiply(r1.data(), r0.data(), r1.data(), t.data());
+        multiply(r0.data(), r0.data(), r0.data(), t.data());
+    }
+    conditionalSwap(r0.data(), r1.data(), n, swap);
+    return leave(r0.data(), t.data());
+}
+
+BigNumModContextCache::BigNumModContextCache(size_t capacity, size_t maxDigits)
+    : capacity_(capacity), maxDigits_(maxDigits), hits(0), misses(0), evictions(0), bypassed(0)
+{
+}
+
+uint64_t BigNumModContextCache::fingerprint(const BigNum &m)
+{
+    // FNV-1a over the digits; the sign is irrelevant to the context
+    uint64_t hash = 14695981039346656037ULL;
+    for (int digit : m.digits)
+    {
+        hash = (hash ^ (uint64_t)digit) * 1099511628211ULL;
+    }
+    return hash ^ m.digits.size();
+}
+
+void BigNumModContextCache::trim()
+{
+    while (entries.size() > capacity_)
+    {
+        index.erase(entries.back().fingerprint);
+        entries.pop_back();
+        evictions++;
+    }
+}
+
+shared_ptr<const BigNumModContext> BigNumModContextCache::get(const BigNum &m)
+{
+    if (m.digits.size() > maxDigits_)
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            bypassed++;
+        }
+        return make_shared<BigNumModContext>(m);
+    }
+
+    uint64_t key = fingerprint(m);
+    {
+        lock_guard<mutex> guard(lock);
+        auto found = index.find(key);
+        if (found != index.end())
+        {
+            const DigitVector &cached = found->second->context->modulus().digits;
+            if (BigNum::compareMagnitude(cached.data(), cached.size(), m.digits.data(), m.digits.size()) == 0)
+            {
+                hits++;
+                entries.splice(entries.begin(), entries, found->second);
+                return found->second->context;
+            }
+        }
+        misses++;
+    }
+
+    // Built outside the lock so that a slow build does not stall other moduli;
+    // two threads missing on one modulus at once both build, and one copy wins
+    shared_ptr<const BigNumModContext> context = make_shared<BigNumModContext>(m);
+    lock_guard<mutex> guard(lock);
+    auto found = index.find(key);
+    if (found != index.end())
+        entries.erase(found->second);
+    entries.push_front(Entry{key, context});
+    index[key] = entries.begin();
+    trim();
+    return context;
+}
+
+const BigNumModContext &BigNumModContextCache::recent(const BigNum &m)
+{
+    // Most recently used first. Contexts depend only on the modulus, so a
+    // slot filled through any cache instance is valid for every one.
+    thread_local shared_ptr<const BigNumModContext> slots[RECENT_PER_THREAD];
+    thread_local shared_ptr<const BigNumModContext> oversized;
+
+    if (m.digitCount() > maxDigits_)
+    {
+        // Not retained past this thread's next call, like get() not retaining it
+        oversized = get(m);
+        return *oversized;
+    }
+
+    for (size_t i = 0; i < RECENT_PER_THREAD && slots[i]; i++)
+    {
+        const BigNum &cached = slots[i]->modulus();
+        if (BigNum::compareMagnitude(cached.digitData(), cached.digitCount(), m.digitData(), m.digitCount()) == 0)
+        {
+            rotate(slots, slots + i, slots + i + 1);
+            return *slots[0];
+        }
+    }
+
+    shared_ptr<const BigNumModContext> context = get(m);
+    rotate(slots, slots + RECENT_PER_THREAD - 1, slots + RECENT_PER_THREAD);
+    slots[0] = std::move(context);
+    return *slots[0];
+}
+
+void BigNumModContextCache::setCapacity(size_t capacity)
+{
+    lock_guard<mutex> guard(lock);
+    capacity_ = capacity;
+    trim();
+}
+
+void BigNumModContextCache::clear()
+{
+    lock_guard<mutex> guard(lock);
+    entries.clear();
+    index.clear();
+}
+
+BigNumModCacheStats BigNumModContextCache::stats()
+{
+    lock_guard<mutex> guard(lock);
+    BigNumModCacheStats result;
+    result.hits = hits;
+    result.misses = misses;
+    result.evictions = evictions;
+    result.bypassed = bypassed;
+    result.entries = entries.size();
+    result.capacity = capacity_;
+    return result;
+}
+
+void BigNumModContextCache::resetStats()
+{
+    lock_guard<mutex> guard(lock);
+    hits = misses = evictions = bypassed = 0;
+}
+
+BigNumModContextCache &BigNumModContextCache::shared()
+{
+    static BigNumModContextCache cache;
+    return cache;
+}
+
+BigNumThreadPool::BigNumThreadPool(size_t threads) : stopping(false)
+{
+    if (threads == 0)
+        threads = max(1u, thread::hardware_concurrency());
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; i++)
+    {
+        workers.emplace_back(&BigNumThreadPool::work, this);
+    }
+}
+
+BigNumThreadPool::~BigNumThreadPool()
+{
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void BigNumThreadPool::work()
+{
+    while (true)
+    {
+        function<void()> task;
+        {
+            unique_lock<mutex> guard(lock);
+            ready.wait(guard, [this]
+                       { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+                return; // stopping and drained
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void BigNumThreadPool::submit(function<void()> task)
+{
+    {
+        lock_guard<mutex> guard(lock);
+        tasks.push_back(std::move(task));
+    }
+    ready.notify_one();
+}
+
+size_t BigNumThreadPool::pending()
+{
+    lock_guard<mutex> guard(lock);
+    return tasks.size();
+}
+
+BigNumThreadPool &BigNumThreadPool::shared()
+{
+    static BigNumThreadPool pool;
+    return pool;
+}
+
+void BigNumArchive::corrupt(const string &what)
+{
+    throw runtime_error("Corrupt BigNum archive: " + what);
+}
+
+void BigNumArchive::write(const string &path, const vector<BigNum> &values)
+{
+    static_assert(sizeof(int) == 4, "archive entries store digits as 32-bit ints");
+
+    uint64_t size = HEADER_SIZE;
+    for (const BigNum &value : values)
+    {
+        size += 8 + 4 * (uint64_t)value.digitCount();
+    }
+    // The index is read in place as uint64s, so it starts 8-aligned; the
+    // mapping is zero-filled, which pads the gap
+    uint64_t indexOffset = (size + 7) / 8 * 8;
+    size = indexOffset + 8 * (uint64_t)values.size();
+
+    MappedFile out = MappedFile::create(path, size);
+    char *base = out.data();
+
+    uint32_t version = VERSION;
+    uint64_t total = values.size(), reserved = 0;
+    memcpy(base, "BNA1", 4);
+    memcpy(base + 4, &version, 4);
+    memcpy(base + 8, &total, 8);
+    memcpy(base + 16, &indexOffset, 8);
+    memcpy(base + 24, &reserved, 8);
+
+    uint64_t offset = HEADER_SIZE;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        const BigNum &value = values[i];
+        uint32_t flags = value.is_negative ? 1 : 0;
+        uint32_t length = value.digitCount();
+        memcpy(base + offset, &flags, 4);
+        memcpy(base + offset + 4, &length, 4);
+        memcpy(base + offset + 8, value.digitData(), 4 * (size_t)length);
+        memcpy(base + indexOffset + 8 * i, &offset, 8);
+        offset += 8 + 4 * (uint64_t)length;
+    }
+}
+
+BigNumArchive BigNumArchive::open(const string &path)
+{
+    BigNumArchive archive(MappedFile::openRead(path));
+    const char *base = archive.file.data();
+    size_t size = archive.file.size();
+
+    if (size < HEADER_SIZE || memcmp(base, "BNA1", 4) != 0)
+        corrupt("bad header in " + path);
+
+    uint32_t version;
+    uint64_t total, indexOffset;
+    memcpy(&version, base + 4, 4);
+    memcpy(&total, base + 8, 8);
+    memcpy(&indexOffset, base + 16, 8);
+    if (version != VERSION)
+        throw runtime_error("Unsupported BigNum archive version in " + path);
+    if (indexOffset % 8 != 0 || indexOffset > size || total > (size - indexOffset) / 8)
+        corrupt("index out of range in " + path);
+
+    archive.offsets = reinterpret_cast<const uint64_t *>(base + indexOffset);
+    archive.count = total;
+    return archive;
+}
+
+BigNumView BigNumArchive::operator[](size_t i) const
+{
+    if (i >= count)
+        throw runtime_error("BigNum archive index out of range");
+
+    const char *base = file.data();
+    uint64_t offset = offsets[i];
+    if (offset % 4 != 0 || offset < HEADER_SIZE || offset > file.size() - 8)
+        corrupt("entry offset out of range");
+
+    uint32_t flags, length;
+    memcpy(&flags, base + offset, 4);
+    memcpy(&length, base + offset + 4, 4);
+    if (length == 0 || length > (file.size() - offset - 8) / 4)
+        corrupt("entry length out of range");
+
+    // Validated on every access, as bignum_rpc does on decode, so a damaged
+    // file cannot feed out-of-range digits to the kernels
+    const int *digits = reinterpret_cast<const int *>(base + offset + 8);
+    for (uint32_t j = 0; j < length; j++)
+    {
+        if (digits[j] < 0 || digits[j] > 9)
+            corrupt("entry digit out of range");
+    }
+    if (length > 1 && digits[length - 1] == 0)
+        corrupt("entry has leading zeros");
+    bool zero = length == 1 && digits[0] == 0;
+    return BigNumView(digits, length, (flags & 1) != 0 && !zero);
+}
+
+Field25519 Field25519::carryWide(Wide t0, Wide t1, Wide t2, Wide t3, Wide t4)
+{
+    Field25519 r;
+    t1 += wideShift51(t0);
+    r.limb[0] = wideLow51(t0);
+    t2 += wideShift51(t1);
+    r.limb[1] = wideLow51(t1);
+    t3 += wideShift51(t2);
+    r.limb[2] = wideLow51(t2);
+    t4 += wideShift51(t3);
+    r.limb[3] = wideLow51(t3);
+    r.limb[4] = wideLow51(t4);
+
+    // 2^255 = 19 (mod p): fold the top carry back into the lowest limb
+    Wide low = wideMul(wideShift51(t4), 19);
+    low += r.limb[0];
+    r.limb[0] = wideLow51(low);
+    r.limb[1] += wideShift51(low);
+    return r;
+}
+
+void Field25519::carry()
+{
+    limb[1] += limb[0] >> 51;
+    limb[0] &= MASK51;
+    limb[2] += limb[1] >> 51;
+    limb[1] &= MASK51;
+    limb[3] += limb[2] >> 51;
+    limb[2] &= MASK51;
+    limb[4] += limb[3] >> 51;
+    limb[3] &= MASK51;
+    limb[0] += 19 * (limb[4] >> 51);
+    limb[4] &= MASK51;
+}
+
+Field25519 Field25519::canonical() const
+{
+    Field25519 t(*this);
+    t.carry();
+    t.carry();
+
+    // Now in [0, 2^255): offset by 19 so that values >= p overflow 2^255
+    t.limb[0] += 19;
+    t.carry();
+
+    // Add 2^255 - 19 and drop the 2^255 bit, subtracting the offset again
+    t.limb[0] += MASK51 + 1 - 19;
+    for (int i = 1; i < 5; i++)
+    {
+        t.limb[i] += MASK51;
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        t.limb[i + 1] += t.limb[i] >> 51;
+        t.limb[i] &= MASK51;
+    }
+    t.limb[4] &= MASK51;
+    return t;
+}
+
+Field25519 Field25519::squareTimes(int count) const
+{
+    Field25519 r(*this);
+    for (int i = 0; i < count; i++)
+    {
+        r = r.square();
+    }
+    return r;
+}
+
+void Field25519::conditionalSwap(Field25519 &a, Field25519 &b, uint64_t swap)
+{
+    uint64_t mask = 0 - swap;
+    for (int i = 0; i < 5; i++)
+    {
+        uint64_t x = mask & (a.limb[i] ^ b.limb[i]);
+        a.limb[i] ^= x;
+        b.limb[i] ^= x;
+    }
+}
+
+void Field25519::scalarToBytes(const BigNum &scalar, uint8_t out[32])
+{
+    if (scalar.is_negative)
+    {
+        throw runtime_error("X25519 scalar must be non-negative");
+    }
+
+    memset(out, 0, 32);
+    for (int i = scalar.digits.size() - 1; i >= 0; i--)
+    {
+        unsigned carry = scalar.digits[i];
+        for (int j = 0; j < 32; j++)
+        {
+            unsigned v = out[j] * 10u + carry;
+            out[j] = v & 0xFF;
+            carry = v >> 8;
+        }
+        if (carry)
+        {
+            throw runtime_error("X25519 scalar exceeds 256 bits");
+        }
+    }
+}
+
+Field25519::Field25519()
+{
+    for (int i = 0; i < 5; i++)
+    {
+        limb[i] = 0;
+    }
+}
+
+Field25519::Field25519(uint64_t value)
+{
+    limb[0] = value & MASK51;
+    limb[1] = value >> 51;
+    limb[2] = limb[3] = limb[4] = 0;
+}
+
+Field25519::Field25519(const BigNum &value)
+{
+    Field25519 acc;
+    for (int i = value.digits.size() - 1; i >= 0; i--)
+    {
+        acc = acc.mulSmall(10) + Field25519((uint64_t)value.digits[i]);
+    }
+    if (value.is_negative)
+    {
+        acc = Field25519() - acc;
+    }
+    for (int i = 0; i < 5; i++)
+    {
+        limb[i] = acc.limb[i];
+    }
+}
+
+Field25519 Field25519::fromBytes(const uint8_t in[32])
+{
+    uint64_t w[4];
+    for (int i = 0; i < 4; i++)
+    {
+        w[i] = 0;
+        for (int j = 7; j >= 0; j--)
+        {
+            w[i] = (w[i] << 8) | in[8 * i + j];
+        }
+    }
+
+    Field25519 r;
+    r.limb[0] = w[0] & MASK51;
+    r.limb[1] = ((w[0] >> 51) | (w[1] << 13)) & MASK51;
+    r.limb[2] = ((w[1] >> 38) | (w[2] << 26)) & MASK51;
+    r.limb[3] = ((w[2] >> 25) | (w[3] << 39)) & MASK51;
+    r.limb[4] = (w[3] >> 12) & MASK51;
+    return r;
+}
+
+void Field25519::toBytes(uint8_t out[32]) const
+{
+    Field25519 t = canonical();
+    uint64_t w[4];
+    w[0] = t.limb[0] | (t.limb[1] << 51);
+    w[1] = (t.limb[1] >> 13) | (t.limb[2] << 38);
+    w[2] = (t.limb[2] >> 26) | (t.limb[3] << 25);
+    w[3] = (t.limb[3] >> 39) | (t.limb[4] << 12);
+
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 8; j++)
+        {
+            out[8 * i + j] = (w[i] >> (8 * j)) & 0xFF;
+        }
+    }
+}
+
+BigNum Field25519::toBigNum() const
+{
+    Field25519 t = canonical();
+    BigNum radix((long long)(MASK51 + 1));
+    BigNum result(0);
+    for (int i = 4; i >= 0; i--)
+    {
+        result = result * radix + BigNum((long long)t.limb[i]);
+    }
+    return result;
+}
+
+bool Field25519::isZero() const
+{
+    Field25519 t = canonical();
+    return (t.limb[0] | t.limb[1] | t.limb[2] | t.limb[3] | t.limb[4]) == 0;
+}
+
+bool Field25519::operator==(const Field25519 &other) const
+{
+    return (*this - other).isZero();
+}
+
+bool Field25519::operator!=(const Field25519 &other) const
+{
+    return !(*this == other);
+}
+
+Field25519 Field25519::operator+(const Field25519 &other) const
+{
+    Field25519 r;
+    for (int i = 0; i < 5; i++)
+    {
+        r.limb[i] = limb[i] + other.limb[i];
+    }
+    return r;
+}
+
+Field25519 Field25519::operator-(const Field25519 &other) const
+{
+    Field25519 b(other);
+    b.carry();
+
+    Field25519 r;
+    r.limb[0] = limb[0] + 4 * (MASK51 + 1 - 19) - b.limb[0];
+    for (int i = 1; i < 5; i++)
+    {
+        r.limb[i] = limb[i] + 4 * MASK51 - b.limb[i];
+    }
+    return r;
+}
+
+Field25519 Field25519::operator-() const
+{
+    return Field25519() - *this;
+}
+
+Field25519 Field25519::operator*(const Field25519 &other) const
+{
+    const uint64_t *a = limb;
+    const uint64_t *b = other.limb;
+    uint64_t b1_19 = 19 * b[1], b2_19 = 19 * b[2];
+    uint64_t b3_19 = 19 * b[3], b4_19 = 19 * b[4];
+
+    Wide t0 = wideMul(a[0], b[0]);
+    t0 += wideMul(a[1], b4_19);
+    t0 += wideMul(a[2], b3_19);
+    t0 += wideMul(a[3], b2_19);
+    t0 += wideMul(a[4], b1_19);
+
+    Wide t1 = wideMul(a[0], b[1]);
+    t1 += wideMul(a[1], b[0]);
+    t1 += wideMul(a[2], b4_19);
+    t1 += wideMul(a[3], b3_19);
+    t1 += wideMul(a[4], b2_19);
+
+    Wide t2 = wideMul(a[0], b[2]);
+    t2 += wideMul(a[1], b[1]);
+    t2 += wideMul(a[2], b[0]);
+    t2 += wideMul(a[3], b4_19);
+    t2 += wideMul(a[4], b3_19);
+
+    Wide t3 = wideMul(a[0], b[3]);
+    t3 += wideMul(a[1], b[2]);
+    t3 += wideMul(a[2], b[1]);
+    t3 += wideMul(a[3], b[0]);
+    t3 += wideMul(a[4], b4_19);
+
+    Wide t4 = wideMul(a[0], b[4]);
+    t4 += wideMul(a[1], b[3]);
+    t4 += wideMul(a[2], b[2]);
+    t4 += wideMul(a[3], b[1]);
+    t4 += wideMul(a[4], b[0]);
+
+    return carryWide(t0, t1, t2, t3, t4);
+}
+
+Field25519 Field25519::square() const
+{
+    const uint64_t *a = limb;
+    uint64_t d0 = 2 * a[0], d1 = 2 * a[1];
+    uint64_t a3_19 = 19 * a[3], a4_19 = 19 * a[4];
+
+    Wide t0 = wideMul(a[0], a[0]);
+    t0 += wideMul(d1, a4_19);
+    t0 += wideMul(2 * a[2], a3_19);
+
+    Wide t1 = wideMul(d0, a[1]);
+    t1 += wideMul(2 * a[2], a4_19);
+    t1 += wideMul(a[3], a3_19);
+
+    Wide t2 = wideMul(d0, a[2]);
+    t2 += wideMul(a[1], a[1]);
+    t2 += wideMul(2 * a[3], a4_19);
+
+    Wide t3 = wideMul(d0, a[3]);
+    t3 += wideMul(d1, a[2]);
+    t3 += wideMul(a[4], a4_19);
+
+    Wide t4 = wideMul(d0, a[4]);
+    t4 += wideMul(d1, a[3]);
+    t4 += wideMul(a[2], a[2]);
+
+    return carryWide(t0, t1, t2, t3, t4);
+}
+
+Field25519 Field25519::mulSmall(uint32_t factor) const
+{
+    return carryWide(wideMul(limb[0], factor), wideMul(limb[1], factor),
+                     wideMul(limb[2], factor), wideMul(limb[3], factor),
+                     wideMul(limb[4], factor));
+}
+
+Field25519 Field25519::invert() const
+{
+    Field25519 z2 = square();
+    Field25519 z9 = z2.squareTimes(2) * *this;
+    Field25519 z11 = z9 * z2;
+    Field25519 z2_5_0 = z11.square() * z9;
+    Field25519 z2_10_0 = z2_5_0.squareTimes(5) * z2_5_0;
+    Field25519 z2_20_0 = z2_10_0.squareTimes(10) * z2_10_0;
+    Field25519 z2_40_0 = z2_20_0.squareTimes(20) * z2_20_0;
+    Field25519 z2_50_0 = z2_40_0.squareTimes(10) * z2_10_0;
+    Field25519 z2_100_0 = z2_50_0.squareTimes(50) * z2_50_0;
+    Field25519 z2_200_0 = z2_100_0.squareTimes(100) * z2_100_0;
+    Field25519 z2_250_0 = z2_200_0.squareTimes(50) * z2_50_0;
+    return z2_250_0.squareTimes(5) * z11;
+}
+
+void Field25519::x25519(uint8_t out[32], const uint8_t scalar[32], const uint8_t u[32])
+{
+    uint8_t k[32];
+    memcpy(k, scalar, 32);
+    k[0] &= 248;
+    k[31] &= 127;
+    k[31] |= 64;
+
+    Field25519 x1 = fromBytes(u);
+    Field25519 x2(1), z2, x3(x1), z3(1);
+    uint64_t swap = 0;
+
+    for (int t = 254; t >= 0; t--)
+    {
+        uint64_t bit = (k[t >> 3] >> (t & 7)) & 1;
+        swap ^= bit;
+        conditionalSwap(x2, x3, swap);
+        conditionalSwap(z2, z3, swap);
+        swap = bit;
+
+        Field25519 a = x2 + z2;
+        Field25519 aa = a.square();
+        Field25519 b = x2 - z2;
+        Field25519 bb = b.square();
+        Field25519 e = aa - bb;
+        Field25519 c = x3 + z3;
+        Field25519 d = x3 - z3;
+        Field25519 da = d * a;
+        Field25519 cb = c * b;
+        x3 = (da + cb).square();
+        z3 = x1 * (da - cb).square();
+        x2 = aa * bb;
+        z2 = e * (aa + e.mulSmall(121665));
+    }
+    conditionalSwap(x2, x3, swap);
+    conditionalSwap(z2, z3, swap);
+
+    (x2 * z2.invert()).toBytes(out);
+}
+
+BigNum Field25519::x25519(const BigNum &scalar, const BigNum &u)
+{
+    uint8_t k[32], in[32], out[32];
+    scalarToBytes(scalar, k);
+    Field25519(u).toBytes(in);
+    x25519(out, k, in);
+    return fromBytes(out).toBigNum();
+}
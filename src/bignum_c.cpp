@@ -0,0 +1,449 @@
+#include "bignum_c.h"
+#include "bignum.hpp"
+
+#include <cstring>
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct bn_num
+{
+    BigNum value;
+};
+
+struct bn_mod_ctx
+{
+    BigNumModContext context;
+
+    explicit bn_mod_ctx(const BigNum &m) : context(m) {}
+};
+
+// Runs body, turning any exception into a status so none crosses the C boundary
+template <typename Body>
+static int guarded(Body body)
+{
+    try
+    {
+        return body();
+    }
+    catch (const bad_alloc &)
+    {
+        return BN_ERR_NO_MEMORY;
+    }
+    catch (...)
+    {
+        return BN_ERR_INTERNAL;
+    }
+}
+
+// Copies bytes into a caller buffer, or reports the size it needs
+static int emit(const void *data, size_t size, size_t extra, void *out, size_t capacity, size_t *len)
+{
+    if (!len)
+        return BN_ERR_NULL_ARGUMENT;
+    *len = size;
+    if (capacity < size + extra)
+        return BN_ERR_BUFFER_TOO_SMALL;
+    if (!out)
+        return BN_ERR_NULL_ARGUMENT;
+    if (size)
+        memcpy(out, data, size);
+    return BN_OK;
+}
+
+// The functions below have C linkage from their declarations in bignum_c.h
+
+int bn_abi_version(void)
+{
+    return BIGNUM_C_ABI_VERSION;
+}
+
+const char *bn_status_string(int status)
+{
+    switch (status)
+    {
+    case BN_OK:
+        return "ok";
+    case BN_ERR_NULL_ARGUMENT:
+        return "null argument";
+    case BN_ERR_DIVISION_BY_ZERO:
+        return "division by zero";
+    case BN_ERR_NO_INVERSE:
+        return "modular inverse does not exist";
+    case BN_ERR_BUFFER_TOO_SMALL:
+        return "buffer too small";
+    case BN_ERR_INVALID_ARGUMENT:
+        return "invalid argument";
+    case BN_ERR_NO_MEMORY:
+        return "out of memory";
+    case BN_ERR_INTERNAL:
+        return "internal error";
+    default:
+        return "unknown status";
+    }
+}
+
+bn_num *bn_new(void)
+{
+    return new (nothrow) bn_num();
+}
+
+void bn_free(bn_num *n)
+{
+    delete n;
+}
+
+int bn_copy(bn_num *dst, const bn_num *src)
+{
+    if (!dst || !src)
+        return BN_ERR_NULL_ARGUMENT;
+    return guarded([&]
+                   {
+                       dst->value = src->value;
+                       return BN_OK;
+                   });
+}
+
+int bn_set_i64(bn_num *n, int64_t value)
+{
+    if (!n)
+        return BN_ERR_NULL_ARGUMENT;
+    return guarded([&]
+                   {
+                       n->value = BigNum((long long)value);
+                       return BN_OK;
+                   });
+}
+
+int bn_set_bytes(bn_num *n, const uint8_t *data, size_t len, int negative)
+{
+    if (!n || (!data && len))
+        return BN_ERR_NULL_ARGUMENT;
+    return guarded([&]
+                   {
+                       n->value = BigNum::fromBytes(data, len);
+                       if (negative)
+                           n->value = -n->value;
+                       return BN_OK;
+                   });
+}
+
+int bn_set_str(bn_num *n, const char *decimal)
+{
+    if (!n || !decimal)
+        return BN_ERR_NULL_ARGUMENT;
+    // Stricter than BigNum(string), which skips non-digit characters
+    const char *p = decimal + (decimal[0] == '-');
+    if (!*p)
+        return BN_ERR_INVALID_ARGUMENT;
+    for (; *p; p++)
+    {
+        if (*p < '0' || *p > '9')
+            return BN_ERR_INVALID_ARGUMENT;
+    }
+    return guarded([&]
+                   {
+                       n->value = BigNum(decimal);
+                       return BN_OK;
+                   });
+}
+
+int bn_get_bytes(const bn_num *n, uint8_t *out, size_t capacity, size_t *len)
+{
+    if (!n)
+        return BN_ERR_NULL_ARGUMENT;
+    return guarded([&]
+                   {
+                       vector<uint8_t> bytes = n->value.toBytes();
+                       return emit(bytes.data(), bytes.size(), 0, out, capacity, len);
+                   });
+}
+
+int bn_get_str(const bn_num *n, char *out, size_t capacity, size_t *len)
+{
+    if (!n)
+        return BN_ERR_NULL_ARGUMENT;
+    return guarded([&]
+                   {
+                       string text = n->value.toString();
+                       int status = emit(text.c_str(), text.size(), 1, out, capacity, len);
+                       if (status == BN_OK)
+                           out[text.size()] = '\0';
+                       return status;
+                   });
+}
+
+int bn_is_negative(const bn_num *n)
+{
+    return n && n->value < BigNum(0);
+}
+
+int bn_is_zero(const bn_num *n)
+{
+    return n && n->value.isZero();
+}
+
+int bn_cmp(const bn_num *a, const bn_num *b)
+{
+    if (!a || !b)
+        return (a != nullptr) - (b != nullptr);
+    if (a->value < b->value)
+        return -1;
+    return a->value == b->value ? 0 : 1;
+}
+
+int bn_add(bn_num *r, const bn_num *a, const bn_num *b)
+{
+    if (!r || !a || !b)
+        return BN_ERR_NULL_ARGUMENT;
+    return guarded([&]
+                   {
+                       r->value = a->value + b->value;
+                       return BN_OK;
+                   });
+}
+
+int bn_sub(bn_num *r, const bn_num *a, const bn_num *b)
+{
+    if (!r || !a || !b)
+        return BN_ERR_NULL_ARGUMENT;
+    return guarded([&]
+                   {
+                       r->value = a->value - b->value;
+                       return BN_OK;
+                   });
+}
+
+int bn_mul(bn_num *r, const bn_num *a, const bn_num *b)
+{
+    if (!r || !a || !b)
+        return BN_ERR_NULL_ARGUMENT;
+    return guarded([&]
+                   {
+                       r->value = a->value * b->value;
+                       return BN_OK;
+                   });
+}
+
+int bn_div(bn_num *r, const bn_num *a, const bn_num *b)
+{
+    if (!r || !a || !b)
+        return BN_ERR_NULL_ARGUMENT;
+    if (b->value.isZero())
+        return BN_ERR_DIVISION_BY_ZERO;
+    return guarded([&]
+                   {
+                       r->value = a->value / b->value;
+                       return BN_OK;
+                   });
+}
+
+int bn_mod(bn_num *r, const bn_num *a, const bn_num *b)
+{
+    if (!r || !a || !b)
+        return BN_ERR_NULL_ARGUMENT;
+    if (b->value.isZero())
+        return BN_ERR_DIVISION_BY_ZERO;
+    return guarded([&]
+                   {
+                       r->value = a->value % b->value;
+                       return BN_OK;
+                   });
+}
+
+int bn_addmod(bn_num *r, const bn_num *a, const bn_num *b, const bn_num *m)
+{
+    if (!r || !a || !b || !m)
+        return BN_ERR_NULL_ARGUMENT;
+    if (m->value.isZero())
+        return BN_ERR_DIVISION_BY_ZERO;
+    return guarded([&]
+                   {
+                       r->value = a->value.addMod(b->value, m->value);
+                       return BN_OK;
+                   });
+}
+
+int bn_mulmod(bn_num *r, const bn_num *a, const bn_num *b, const bn_num *m)
+{
+    if (!r || !a || !b || !m)
+        return BN_ERR_NULL_ARGUMENT;
+    if (m->value.isZero())
+        return BN_ERR_DIVISION_BY_ZERO;
+    return guarded([&]
+                   {
+                       r->value = a->value.mulMod(b->value, m->value);
+                       return BN_OK;
+                   });
+}
+
+int bn_powmod(bn_num *r, const bn_num *base, const bn_num *exp, const bn_num *m)
+{
+    if (!r || !base || !exp || !m)
+        return BN_ERR_NULL_ARGUMENT;
+    if (m->value.isZero())
+        return BN_ERR_DIVISION_BY_ZERO;
+    return guarded([&]
+                   {
+                       r->value = base->value.powMod(exp->value, m->value);
+                       return BN_OK;
+                   });
+}
+
+int bn_powmod_consttime(bn_num *r, const bn_num *base, const bn_num *exp, const bn_num *m)
+{
+    if (!r || !base || !exp || !m)
+        return BN_ERR_NULL_ARGUMENT;
+    if (m->value.isZero())
+        return BN_ERR_DIVISION_BY_ZERO;
+    return guarded([&]
+                   {
+                       try
+                       {
+                           r->value = BigNumMontgomery(m->value).powModConstTime(base->value, exp->value);
+                       }
+                       catch (const runtime_error &)
+                       {
+                           return (int)BN_ERR_INVALID_ARGUMENT; // even modulus
+                       }
+                       return (int)BN_OK;
+                   });
+}
+
+int bn_modinverse(bn_num *r, const bn_num *a, const bn_num *m)
+{
+    if (!r || !a || !m)
+        return BN_ERR_NULL_ARGUMENT;
+    if (m->value.isZero())
+        return BN_ERR_DIVISION_BY_ZERO;
+    return guarded([&]
+                   {
+                       try
+                       {
+                           r->value = a->value.modInverse(m->value);
+                       }
+                       catch (const runtime_error &)
+                       {
+                           return (int)BN_ERR_NO_INVERSE;
+                       }
+                       return (int)BN_OK;
+                   });
+}
+
+int bn_mod_ctx_new(bn_mod_ctx **ctx, const bn_num *m)
+{
+    if (!ctx || !m)
+        return BN_ERR_NULL_ARGUMENT;
+    *ctx = nullptr;
+    if (m->value.isZero())
+        return BN_ERR_DIVISION_BY_ZERO;
+    return guarded([&]
+                   {
+                       *ctx = new bn_mod_ctx(m->value);
+                       return BN_OK;
+                   });
+}
+
+void bn_mod_ctx_free(bn_mod_ctx *ctx)
+{
+    delete ctx;
+}
+
+size_t bn_mod_ctx_byte_length(const bn_mod_ctx *ctx)
+{
+    return ctx ? ctx->context.byteLength() : 0;
+}
+
+int bn_addmod_ctx(bn_num *r, const bn_num *a, const bn_num *b, const bn_mod_ctx *ctx)
+{
+    if (!r || !a || !b || !ctx)
+        return BN_ERR_NULL_ARGUMENT;
+    return guarded([&]
+                   {
+                       r->value = ctx->context.addMod(a->value, b->value);
+                       return BN_OK;
+                   });
+}
+
+int bn_mulmod_ctx(bn_num *r, const bn_num *a, const bn_num *b, const bn_mod_ctx *ctx)
+{
+    if (!r || !a || !b || !ctx)
+        return BN_ERR_NULL_ARGUMENT;
+    return guarded([&]
+                   {
+                       r->value = ctx->context.mulMod(a->value, b->value);
+                       return BN_OK;
+                   });
+}
+
+int bn_powmod_ctx(bn_num *r, const bn_num *base, const bn_num *exp, const bn_mod_ctx *ctx)
+{
+    if (!r || !base || !exp || !ctx)
+        return BN_ERR_NULL_ARGUMENT;
+    return guarded([&]
+                   {
+                       r->value = ctx->context.powMod(base->value, exp->value);
+                       return BN_OK;
+                   });
+}
+
+int bn_batch_powmod(bn_num *const *results, const bn_num *const *bases, const bn_num *const *exps, size_t count,
+                    const bn_mod_ctx *ctx)
+{
+    if (!ctx || (count && (!results || !bases || !exps)))
+        return BN_ERR_NULL_ARGUMENT;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!results[i] || !bases[i] || !exps[i])
+            return BN_ERR_NULL_ARGUMENT;
+    }
+    return guarded([&]
+                   {
+                       // Operands are gathered so the batch runs on the context's
+                       // parallel path; results may alias the inputs
+                       vector<BigNum> b(count), e(count), r(count);
+                       for (size_t i = 0; i < count; i++)
+                       {
+                           b[i] = bases[i]->value;
+                           e[i] = exps[i]->value;
+                       }
+                       ctx->context.powModBatch(b.data(), e.data(), r.data(), count);
+                       for (size_t i = 0; i < count; i++)
+                       {
+                           results[i]->value = r[i];
+                       }
+                       return BN_OK;
+                   });
+}
+
+int bn_batch_powmod_bytes(uint8_t *out, size_t out_width, const uint8_t *bases, size_t base_width,
+                          const uint8_t *exps, size_t exp_width, size_t count, const bn_mod_ctx *ctx)
+{
+    if (!ctx || (count && (!out || (!bases && base_width) || (!exps && exp_width))))
+        return BN_ERR_NULL_ARGUMENT;
+    if (out_width < ctx->context.byteLength())
+        return BN_ERR_BUFFER_TOO_SMALL;
+    return guarded([&]
+                   {
+                       vector<BigNum> b(count), e(count), r(count);
+                       for (size_t i = 0; i < count; i++)
+                       {
+                           b[i] = BigNum::fromBytes(bases + i * base_width, base_width);
+                           e[i] = BigNum::fromBytes(exps + i * exp_width, exp_width);
+                       }
+                       ctx->context.powModBatch(b.data(), e.data(), r.data(), count);
+                       for (size_t i = 0; i < count; i++)
+                       {
+                           vector<uint8_t> bytes = r[i].toBytes();
+                           uint8_t *slot = out + i * out_width;
+                           memset(slot, 0, out_width - bytes.size());
+                           if (!bytes.empty())
+                               memcpy(slot + out_width - bytes.size(), bytes.data(), bytes.size());
+                       }
+                       return BN_OK;
+                   });
+}
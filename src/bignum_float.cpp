@@ -0,0 +1,569 @@
+#include "bignum_float.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+// Operands shorter than this (in digits) divide faster by a context's long
+// division than by Newton's reciprocal, whose multiplications are only
+// subquadratic past the Karatsuba threshold
+static size_t newtonThreshold()
+{
+    return 2 * BigNum::tuning().karatsubaThreshold;
+}
+
+// Number of decimal digits in v
+static size_t decimalDigits(uint64_t v)
+{
+    size_t n = 1;
+    while (v >= 10)
+    {
+        v /= 10;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * Whether a short product t (trimmed, computed with BigNum::mulShort at the
+ * given skip) settles the rounding to p digits of the full product P, which
+ * lies in [t, t + 9 * skip * 10^skip). Rounding with a sticky bit then
+ * gives the same result as rounding P. Below the rounding digit c, t has
+ * zeros under skip and a window of at least decimalDigits(9 * skip) + 1
+ * digits above it.
+ */
+static bool shortProductSettles(const DigitVector &t, size_t skip, size_t p)
+{
+    const size_t r = t.size() - p; // digits below the kept ones
+    const int c = t[r - 1];
+    if (c <= 3 || c > 5)
+        return true;
+
+    bool lowNonzero = false;
+    for (size_t i = skip; i + 1 < r; i++)
+    {
+        lowNonzero = lowNonzero || t[i] != 0;
+    }
+    if (c == 5)
+        return lowNonzero;
+
+    // c == 4: settled if adding the error bound to the window below c cannot
+    // carry into c, or lands exactly on the midpoint
+    uint64_t carry = 9 * (uint64_t)skip;
+    bool allZero = true;
+    for (size_t i = skip; i + 1 < r; i++)
+    {
+        uint64_t v = t[i] + carry;
+        carry = v / 10;
+        allZero = allZero && v % 10 == 0;
+    }
+    return carry == 0 || (carry == 1 && allZero);
+}
+
+size_t BigFloat::digitsForPrecision(int bits)
+{
+    if (bits < 1)
+        throw runtime_error("BigFloat precision must be at least one bit");
+    // 0.30103 rounds log10 2 up, so the digits never fall short of the bits
+    return 1 + (size_t)(((int64_t)bits * 30103 + 99999) / 100000);
+}
+
+BigFloat BigFloat::rounded(DigitVector &magnitude, bool negative, int64_t exponent, bool sticky, int precision)
+{
+    const size_t p = digitsForPrecision(precision);
+    BigNum::trimZeros(magnitude);
+
+    BigFloat result;
+    result.precision_ = precision;
+    if (magnitude.empty() || (magnitude.size() == 1 && magnitude[0] == 0))
+        return result;
+
+    if (magnitude.size() > p)
+    {
+        // Round to nearest, ties to even; sticky breaks what looks like a tie
+        size_t drop = magnitude.size() - p;
+        int digit = magnitude[drop - 1];
+        bool rest = sticky;
+        for (size_t i = 0; i + 1 < drop && !rest; i++)
+        {
+            rest = magnitude[i] != 0;
+        }
+        bool up = digit > 5 || (digit == 5 && (rest || (magnitude[drop] & 1)));
+
+        magnitude.erase(magnitude.begin(), magnitude.begin() + drop);
+        exponent += (int64_t)drop;
+        if (up)
+        {
+            size_t i = 0;
+            while (i < magnitude.size() && magnitude[i] == 9)
+            {
+                magnitude[i++] = 0;
+            }
+            if (i == magnitude.size())
+                magnitude.push_back(1);
+            else
+                magnitude[i]++;
+        }
+    }
+
+    size_t zeros = 0;
+    while (magnitude[zeros] == 0)
+    {
+        zeros++;
+    }
+    magnitude.erase(magnitude.begin(), magnitude.begin() + zeros);
+    exponent += (int64_t)zeros;
+
+    result.mantissa_.digits.swap(magnitude);
+    result.mantissa_.is_negative = negative;
+    result.exponent_ = exponent;
+    return result;
+}
+
+BigNum BigFloat::shifted(const BigNum &x, int64_t places)
+{
+    if (places == 0 || x.isZero())
+        return x;
+
+    BigNum result;
+    if (places > 0)
+    {
+        result.digits.assign((size_t)places, 0);
+        result.digits.insert(result.digits.end(), x.digits.begin(), x.digits.end());
+    }
+    else
+    {
+        size_t drop = (size_t)-places;
+        if (drop >= x.digits.size())
+            return BigNum(0);
+        result.digits.assign(x.digits.begin() + drop, x.digits.end());
+    }
+    result.is_negative = x.is_negative;
+    return result;
+}
+
+BigNum BigFloat::reciprocal(const BigNum &d, size_t k)
+{
+    // Only the top k + 4 digits of d can move the first k + 1 digits of the result
+    const size_t n = d.digits.size();
+    const size_t t = min(n, k + 4);
+    BigNum top = shifted(d, -(int64_t)(n - t));
+    if (k < newtonThreshold())
+        return BigNumModContext(top).divide(shifted(BigNum(1), (int64_t)(t + k)));
+
+    // x ~ 10^(t + h) / top at half the digits, then one Newton step:
+    // 10^(t + k) / top ~ x 10^(k - h) + x (10^(t + h) - top x) / 10^(t + 2h - k)
+    const size_t h = k / 2 + 3;
+    BigNum x = reciprocal(top, h);
+    BigNum e = shifted(BigNum(1), (int64_t)(t + h)) - top * x;
+
+    // e's low m digits move the correction by less than a unit
+    const size_t m = t + h > k + 2 ? t + h - k - 2 : 0;
+    BigNum correction = shifted(x * shifted(e, -(int64_t)m), (int64_t)m - (int64_t)(t + 2 * h - k));
+    return shifted(x, (int64_t)(k - h)) + correction;
+}
+
+void BigFloat::divRem(const BigNum &n, const BigNum &d, BigNum &quotient, BigNum &remainder)
+{
+    if (n < d)
+    {
+        quotient = BigNum(0);
+        remainder = n;
+        return;
+    }
+
+    const size_t ln = n.digits.size(), ld = d.digits.size();
+    const size_t qlen = ln - ld + 1;
+    if (min(qlen, ld) < newtonThreshold())
+    {
+        quotient = BigNumModContext(d).divide(n);
+        remainder = n - quotient * d;
+        return;
+    }
+
+    // Estimate from the top qlen + 4 digits of n and a reciprocal good to
+    // a couple of digits beyond the quotient, then settle the last unit
+    // with the exact remainder
+    const size_t k = qlen + 2;
+    const size_t drop = ln > qlen + 4 ? ln - (qlen + 4) : 0;
+    BigNum inverse = reciprocal(d, k);
+    quotient = shifted(shifted(n, -(int64_t)drop) * inverse, (int64_t)drop - (int64_t)(ld + k));
+    remainder = n - quotient * d;
+    while (remainder.is_negative)
+    {
+        quotient -= BigNum(1);
+        remainder += d;
+    }
+    while (remainder >= d)
+    {
+        quotient += BigNum(1);
+        remainder -= d;
+    }
+}
+
+BigNum BigFloat::isqrt(const BigNum &n)
+{
+    if (n.digits.size() <= 18)
+    {
+        uint64_t v = 0;
+        for (size_t i = n.digits.size(); i-- > 0;)
+        {
+            v = v * 10 + n.digits[i];
+        }
+        uint64_t s = (uint64_t)std::sqrt((long double)v);
+        while (s * s > v)
+            s--;
+        while ((s + 1) * (s + 1) <= v)
+            s++;
+        return BigNum((long long)s);
+    }
+
+    // The root of the top half, pushed up to x >= sqrt(n), is off by at
+    // most 10^m, so one Newton step lands within 10^(2m) / (2x) < 2 of the
+    // root, and a square settles the last units instead of a second division
+    const size_t m = n.digits.size() / 4;
+    BigNum x = shifted(isqrt(shifted(n, -(int64_t)(2 * m))) + BigNum(1), (int64_t)m);
+    BigNum q, r;
+    divRem(n, x, q, r);
+    BigNum y = shifted((x + q) * BigNum(5), -1); // (x + q) / 2
+    BigNum square = y * y;
+    while (square > n)
+    {
+        square -= y + y - BigNum(1); // (y - 1)^2
+        y -= BigNum(1);
+    }
+    for (BigNum next = square + y + y + BigNum(1); next <= n; next = square + y + y + BigNum(1))
+    {
+        square = std::move(next);
+        y += BigNum(1);
+    }
+    return y;
+}
+
+BigFloat::BigFloat() : mantissa_(0), exponent_(0), precision_(DEFAULT_PRECISION)
+{
+}
+
+BigFloat::BigFloat(const BigNum &value, int precision) : BigFloat(value, 0, precision)
+{
+}
+
+BigFloat::BigFloat(const BigNum &mantissa, int64_t exponent, int precision) : BigFloat()
+{
+    DigitVector magnitude(mantissa.digitData(), mantissa.digitData() + mantissa.digitCount());
+    *this = rounded(magnitude, mantissa.is_negative, exponent, false, precision);
+}
+
+BigFloat::BigFloat(const string &text, int precision) : BigFloat()
+{
+    size_t i = 0;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+        negative = text[i++] == '-';
+
+    string digits;
+    int64_t exponent = 0;
+    bool point = false;
+    for (; i < text.size(); i++)
+    {
+        if (isdigit((unsigned char)text[i]))
+        {
+            digits += text[i];
+            if (point)
+                exponent--;
+        }
+        else if (text[i] == '.' && !point)
+        {
+            point = true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    bool valid = !digits.empty();
+    if (valid && i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+    {
+        i++;
+        bool negativeExponent = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+'))
+            negativeExponent = text[i++] == '-';
+        size_t start = i;
+        int64_t value = 0;
+        for (; i < text.size() && isdigit((unsigned char)text[i]) && value < INT64_MAX / 100; i++)
+        {
+            value = value * 10 + (text[i] - '0');
+        }
+        valid = i > start;
+        exponent += negativeExponent ? -value : value;
+    }
+    if (!valid || i != text.size())
+        throw runtime_error("Invalid BigFloat: " + text);
+
+    BigNum mantissa(digits);
+    mantissa.is_negative = negative && !mantissa.isZero();
+    *this = BigFloat(mantissa, exponent, precision);
+}
+
+BigFloat::BigFloat(const char *text, int precision) : BigFloat(string(text), precision)
+{
+}
+
+int BigFloat::sign() const
+{
+    return isZero() ? 0 : (mantissa_.is_negative ? -1 : 1);
+}
+
+BigFloat BigFloat::add(const BigFloat &a, const BigFloat &b, int precision, bool negateB)
+{
+    const size_t p = digitsForPrecision(precision);
+    if (a.isZero() || b.isZero())
+    {
+        const BigFloat &nonzero = a.isZero() ? b : a;
+        DigitVector magnitude(nonzero.mantissa_.digits);
+        bool negative = nonzero.mantissa_.is_negative != (a.isZero() && negateB);
+        return rounded(magnitude, negative, nonzero.exponent_, false, precision);
+    }
+
+    // x is the operand reaching the higher digit position
+    int64_t topA = a.exponent_ + (int64_t)a.mantissa_.digits.size();
+    int64_t topB = b.exponent_ + (int64_t)b.mantissa_.digits.size();
+    const bool aLeads = topA >= topB;
+    const BigFloat &x = aLeads ? a : b;
+    const BigFloat &y = aLeads ? b : a;
+    const int64_t topX = max(topA, topB), topY = min(topA, topB);
+
+    BigNum ys = y.mantissa_;
+    int64_t yExponent = y.exponent_;
+    const int64_t cutoff = min(topX - (int64_t)p - 3, x.exponent_);
+    if (topY <= topX - 2 && y.exponent_ < cutoff)
+    {
+        // y sits at least two digits below x, so the sum keeps at least p + 3
+        // digits above cutoff. y's digits under cutoff (its last digit is
+        // non-zero) fold into one sticky digit below it, which leaves the
+        // sum between the same two multiples of 10^cutoff and so rounds alike.
+        ys = shifted(shifted(y.mantissa_, y.exponent_ - cutoff), 1);
+        if (ys.isZero())
+            ys.is_negative = y.mantissa_.is_negative;
+        ys.digits[0] = 1;
+        yExponent = cutoff - 1;
+    }
+
+    const int64_t base = min(x.exponent_, yExponent);
+    BigNum xs = shifted(x.mantissa_, x.exponent_ - base);
+    ys = shifted(ys, yExponent - base);
+
+    BigNum sum;
+    if (aLeads)
+        BigNum::addSigned(sum, xs, ys, negateB);
+    else
+        BigNum::addSigned(sum, ys, xs, negateB);
+    return rounded(sum.digits, sum.is_negative, base, false, precision);
+}
+
+BigFloat BigFloat::add(const BigFloat &a, const BigFloat &b, int precision)
+{
+    return add(a, b, precision, false);
+}
+
+BigFloat BigFloat::sub(const BigFloat &a, const BigFloat &b, int precision)
+{
+    return add(a, b, precision, true);
+}
+
+BigFloat BigFloat::mul(const BigFloat &a, const BigFloat &b, int precision)
+{
+    const size_t p = digitsForPrecision(precision);
+    if (a.isZero() || b.isZero())
+    {
+        BigFloat zero;
+        zero.precision_ = precision;
+        return zero;
+    }
+
+    const bool negative = a.mantissa_.is_negative != b.mantissa_.is_negative;
+    const int64_t exponent = a.exponent_ + b.exponent_;
+    const DigitVector &x = a.mantissa_.digits, &y = b.mantissa_.digits;
+    const size_t total = x.size() + y.size();
+
+    // Guard digits between the skipped columns and the rounding digit hold
+    // the short product's error bound, 9 * skip * 10^skip
+    const size_t guard = 2 + decimalDigits(9 * (uint64_t)total);
+    if (total > p + guard)
+    {
+        size_t skip = total - p - guard;
+        DigitVector t = BigNum::mulShort(x.data(), x.size(), y.data(), y.size(), skip);
+        BigNum::trimZeros(t);
+        if (shortProductSettles(t, skip, p))
+            return rounded(t, negative, exponent, true, precision);
+    }
+
+    DigitVector product = BigNum::mulMagnitude(x.data(), x.size(), y.data(), y.size());
+    return rounded(product, negative, exponent, false, precision);
+}
+
+BigFloat BigFloat::div(const BigFloat &a, const BigFloat &b, int precision)
+{
+    const size_t p = digitsForPrecision(precision);
+    if (b.isZero())
+        throw runtime_error("Division by zero");
+    if (a.isZero())
+    {
+        BigFloat zero;
+        zero.precision_ = precision;
+        return zero;
+    }
+
+    // floor(|a| 10^s / |b|) has at least p + 2 digits; a negative s drops
+    // non-zero digits of a, which only the sticky bit needs to know about
+    BigNum x = a.mantissa_, y = b.mantissa_;
+    x.is_negative = false;
+    y.is_negative = false;
+    const int64_t s = (int64_t)p + 2 + (int64_t)y.digits.size() - (int64_t)x.digits.size();
+
+    BigNum quotient, remainder;
+    divRem(shifted(x, s), y, quotient, remainder);
+    bool negative = a.mantissa_.is_negative != b.mantissa_.is_negative;
+    return rounded(quotient.digits, negative, a.exponent_ - b.exponent_ - s, s < 0 || !remainder.isZero(), precision);
+}
+
+BigFloat BigFloat::sqrt(const BigFloat &a, int precision)
+{
+    const size_t p = digitsForPrecision(precision);
+    if (a.mantissa_.is_negative)
+        throw runtime_error("Square root of a negative BigFloat");
+    if (a.isZero())
+    {
+        BigFloat zero;
+        zero.precision_ = precision;
+        return zero;
+    }
+
+    // A root of at least p + 2 digits needs 2p + 3 digits under it, and the
+    // exponent left over must be even
+    int64_t s = 2 * (int64_t)p + 4 - (int64_t)a.mantissa_.digits.size();
+    if ((a.exponent_ - s) % 2 != 0)
+        s++;
+
+    BigNum n = shifted(a.mantissa_, s);
+    BigNum root = isqrt(n);
+    bool sticky = s < 0 || root * root != n;
+    return rounded(root.digits, false, (a.exponent_ - s) / 2, sticky, precision);
+}
+
+BigFloat BigFloat::operator-() const
+{
+    BigFloat result(*this);
+    result.mantissa_.is_negative = !isZero() && !mantissa_.is_negative;
+    return result;
+}
+
+BigFloat BigFloat::operator+(const BigFloat &other) const
+{
+    return add(*this, other, max(precision_, other.precision_), false);
+}
+
+BigFloat BigFloat::operator-(const BigFloat &other) const
+{
+    return add(*this, other, max(precision_, other.precision_), true);
+}
+
+BigFloat BigFloat::operator*(const BigFloat &other) const
+{
+    return mul(*this, other, max(precision_, other.precision_));
+}
+
+BigFloat BigFloat::operator/(const BigFloat &other) const
+{
+    return div(*this, other, max(precision_, other.precision_));
+}
+
+BigFloat BigFloat::sqrt() const
+{
+    return sqrt(*this, precision_);
+}
+
+bool BigFloat::operator==(const BigFloat &other) const
+{
+    // Mantissas carry no trailing zeros, so equal values have equal parts
+    return exponent_ == other.exponent_ && mantissa_ == other.mantissa_;
+}
+
+bool BigFloat::operator<(const BigFloat &other) const
+{
+    if (sign() != other.sign())
+        return sign() < other.sign();
+    if (isZero())
+        return false;
+
+    int64_t top = exponent_ + (int64_t)mantissa_.digits.size();
+    int64_t otherTop = other.exponent_ + (int64_t)other.mantissa_.digits.size();
+    bool smaller;
+    if (top != otherTop)
+    {
+        smaller = top < otherTop;
+    }
+    else
+    {
+        int64_t base = min(exponent_, other.exponent_);
+        BigNum x = shifted(mantissa_, exponent_ - base), y = shifted(other.mantissa_, other.exponent_ - base);
+        int c = BigNum::compareMagnitude(x.digits.data(), x.digits.size(), y.digits.data(), y.digits.size());
+        if (c == 0)
+            return false;
+        smaller = c < 0;
+    }
+    return smaller != (sign() < 0);
+}
+
+BigNum BigFloat::toBigNum() const
+{
+    return shifted(mantissa_, exponent_);
+}
+
+string BigFloat::toString() const
+{
+    if (isZero())
+        return "0";
+
+    string digits = mantissa_.toString();
+    string out;
+    if (digits[0] == '-')
+    {
+        out = "-";
+        digits.erase(0, 1);
+    }
+
+    const int64_t n = (int64_t)digits.size();
+    const int64_t scientific = exponent_ + n - 1;
+    if (scientific > -7 && scientific < 21)
+    {
+        if (exponent_ >= 0)
+            out += digits + string((size_t)exponent_, '0');
+        else if (scientific >= 0)
+            out += digits.substr(0, (size_t)(n + exponent_)) + "." + digits.substr((size_t)(n + exponent_));
+        else
+            out += "0." + string((size_t)(-scientific - 1), '0') + digits;
+    }
+    else
+    {
+        out += digits[0];
+        if (n > 1)
+            out += "." + digits.substr(1);
+        out += (scientific < 0 ? "e-" : "e+") + to_string(scientific < 0 ? -scientific : scientific);
+    }
+    return out;
+}
+
+ostream &operator<<(ostream &os, const BigFloat &value)
+{
+    return os << value.toString();
+}
@@ -0,0 +1,265 @@
+#include "bignum_rational.hpp"
+
+#include <atomic>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+static atomic<size_t> rationalNormalizeThreshold(BigRational::DEFAULT_NORMALIZE_THRESHOLD);
+
+// gcd that skips the Euclid loop when either side is a unit
+static BigNum commonFactor(const BigNum &a, const BigNum &b)
+{
+    if (a.isOne() || b.isOne())
+        return BigNum(1);
+    return BigNum::gcd(a, b);
+}
+
+// v / g for a g that divides v exactly, by the context's long division
+static BigNum divideOut(const BigNum &v, const BigNum &g)
+{
+    return g.isOne() ? v : BigNumModContext(g).divide(v);
+}
+
+BigRational::BigRational(BigNum num, BigNum den, bool reduced)
+    : num_(std::move(num)), den_(std::move(den)), reduced_(reduced)
+{
+    if (num_.isZero())
+    {
+        den_ = BigNum(1);
+        reduced_ = true;
+    }
+    else if (den_.isOne())
+    {
+        reduced_ = true;
+    }
+}
+
+BigRational::BigRational() : num_(0), den_(1), reduced_(true)
+{
+}
+
+BigRational::BigRational(const BigNum &value) : num_(value), den_(1), reduced_(true)
+{
+}
+
+BigRational::BigRational(long long value) : num_(value), den_(1), reduced_(true)
+{
+}
+
+BigRational::BigRational(const BigNum &num, const BigNum &den) : num_(num), den_(den), reduced_(false)
+{
+    if (den_.isZero())
+        throw runtime_error("BigRational denominator is zero");
+    if (den_.is_negative)
+    {
+        den_.is_negative = false;
+        num_.is_negative = !num_.is_negative && !num_.isZero();
+    }
+    if (num_.isZero())
+        den_ = BigNum(1);
+    reduced_ = den_.isOne();
+}
+
+// An optional '-' and at least one digit, as bn_set_str accepts; stricter
+// than BigNum(string), which skips non-digit characters
+static BigNum parseTerm(const string &term, const string &text)
+{
+    size_t first = !term.empty() && term[0] == '-';
+    if (first == term.size() || term.find_first_not_of("0123456789", first) != string::npos)
+        throw runtime_error("Malformed BigRational '" + text + "'");
+    return BigNum(term);
+}
+
+BigRational::BigRational(const string &text) : BigRational()
+{
+    size_t slash = text.find('/');
+    if (slash == string::npos)
+        *this = BigRational(parseTerm(text, text));
+    else
+        *this = BigRational(parseTerm(text.substr(0, slash), text), parseTerm(text.substr(slash + 1), text));
+}
+
+BigRational::BigRational(const char *text) : BigRational(string(text))
+{
+}
+
+void BigRational::setNormalizeThreshold(size_t digits)
+{
+    rationalNormalizeThreshold.store(digits, memory_order_relaxed);
+}
+
+size_t BigRational::normalizeThreshold()
+{
+    return rationalNormalizeThreshold.load(memory_order_relaxed);
+}
+
+size_t BigRational::digitCount() const
+{
+    return num_.digits.size() + den_.digits.size();
+}
+
+BigRational &BigRational::canonicalize()
+{
+    if (!reduced_)
+    {
+        BigNum g = BigNum::gcd(num_, den_);
+        if (!g.isOne())
+        {
+            BigNumModContext byG(g);
+            num_ = byG.divide(num_);
+            den_ = byG.divide(den_);
+        }
+        reduced_ = true;
+    }
+    return *this;
+}
+
+BigRational BigRational::reduced() const
+{
+    BigRational copy(*this);
+    copy.canonicalize();
+    return copy;
+}
+
+bool BigRational::isInteger() const
+{
+    return reduced_ ? den_.isOne() : BigNumModContext(den_).reduce(num_).isZero();
+}
+
+int BigRational::sign() const
+{
+    return num_.isZero() ? 0 : (num_.is_negative ? -1 : 1);
+}
+
+BigRational BigRational::add(const BigRational &a, const BigRational &b, bool negateB)
+{
+    BigNum num;
+    if (a.digitCount() + b.digitCount() <= normalizeThreshold())
+    {
+        // Small operands: combine as they are and leave the result unreduced
+        if (a.den_ == b.den_)
+        {
+            BigNum::addSigned(num, a.num_, b.num_, negateB);
+            return BigRational(std::move(num), a.den_, a.den_.isOne());
+        }
+        BigNum::addSigned(num, a.num_ * b.den_, b.num_ * a.den_, negateB);
+        return BigRational(std::move(num), a.den_ * b.den_, false);
+    }
+
+    BigRational ra, rb;
+    const BigRational &x = a.reduced_ ? a : (ra = a.reduced());
+    const BigRational &y = b.reduced_ ? b : (rb = b.reduced());
+
+    // a/b + c/d with g = gcd(b, d): a (d/g) + c (b/g) shares with the
+    // denominator at most factors of g
+    BigNum g = commonFactor(x.den_, y.den_);
+    BigNum bg = divideOut(x.den_, g), dg = divideOut(y.den_, g);
+    BigNum::addSigned(num, x.num_ * dg, y.num_ * bg, negateB);
+    if (g.isOne())
+        return BigRational(std::move(num), bg * dg, true);
+
+    BigNum g2 = commonFactor(num, g);
+    return BigRational(divideOut(num, g2), bg * divideOut(y.den_, g2), true);
+}
+
+BigRational BigRational::multiply(const BigRational &a, const BigRational &b)
+{
+    if (a.digitCount() + b.digitCount() <= normalizeThreshold())
+        return BigRational(a.num_ * b.num_, a.den_ * b.den_, a.den_.isOne() && b.den_.isOne());
+
+    BigRational ra, rb;
+    const BigRational &x = a.reduced_ ? a : (ra = a.reduced());
+    const BigRational &y = b.reduced_ ? b : (rb = b.reduced());
+
+    // Cancel across before multiplying, so the product needs no gcd
+    BigNum g1 = commonFactor(x.num_, y.den_);
+    BigNum g2 = commonFactor(y.num_, x.den_);
+    return BigRational(divideOut(x.num_, g1) * divideOut(y.num_, g2),
+                       divideOut(x.den_, g2) * divideOut(y.den_, g1), true);
+}
+
+BigRational BigRational::operator-() const
+{
+    return BigRational(-num_, den_, reduced_);
+}
+
+BigRational BigRational::operator+(const BigRational &other) const
+{
+    return add(*this, other, false);
+}
+
+BigRational BigRational::operator-(const BigRational &other) const
+{
+    return add(*this, other, true);
+}
+
+BigRational BigRational::operator*(const BigRational &other) const
+{
+    return multiply(*this, other);
+}
+
+BigRational BigRational::operator/(const BigRational &other) const
+{
+    if (other.isZero())
+        throw runtime_error("Division by zero");
+
+    // The reciprocal keeps the sign on top and is reduced if other is
+    BigNum num = other.den_, den = other.num_;
+    num.is_negative = den.is_negative;
+    den.is_negative = false;
+    return multiply(*this, BigRational(std::move(num), std::move(den), other.reduced_));
+}
+
+BigRational &BigRational::operator+=(const BigRational &other)
+{
+    return *this = add(*this, other, false);
+}
+
+BigRational &BigRational::operator-=(const BigRational &other)
+{
+    return *this = add(*this, other, true);
+}
+
+BigRational &BigRational::operator*=(const BigRational &other)
+{
+    return *this = multiply(*this, other);
+}
+
+BigRational &BigRational::operator/=(const BigRational &other)
+{
+    return *this = *this / other;
+}
+
+bool BigRational::operator==(const BigRational &other) const
+{
+    if (den_ == other.den_)
+        return num_ == other.num_;
+    if ((reduced_ && other.reduced_) || sign() != other.sign())
+        return false;
+    return num_ * other.den_ == other.num_ * den_;
+}
+
+bool BigRational::operator<(const BigRational &other) const
+{
+    if (sign() != other.sign())
+        return sign() < other.sign();
+    if (den_ == other.den_)
+        return num_ < other.num_;
+    return num_ * other.den_ < other.num_ * den_;
+}
+
+string BigRational::toString() const
+{
+    if (!reduced_)
+        return reduced().toString();
+    return den_.isOne() ? num_.toString() : num_.toString() + "/" + den_.toString();
+}
+
+ostream &operator<<(ostream &os, const BigRational &value)
+{
+    return os << value.toString();
+}
@@ -0,0 +1,141 @@
+#include "bignum_rpc.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static void put32(vector<uint8_t> &out, uint32_t value)
+{
+    size_t at = out.size();
+    out.resize(at + 4);
+    memcpy(&out[at], &value, 4);
+}
+
+static void put16(vector<uint8_t> &out, uint16_t value)
+{
+    size_t at = out.size();
+    out.resize(at + 2);
+    memcpy(&out[at], &value, 2);
+}
+
+int BigNumRpc::arity(int op)
+{
+    switch (op)
+    {
+    case RPC_PING:
+        return 0;
+    case RPC_ADD:
+    case RPC_SUB:
+    case RPC_MUL:
+    case RPC_DIV:
+    case RPC_MOD:
+    case RPC_INVERSE:
+        return 2;
+    case RPC_ADDMOD:
+    case RPC_MULMOD:
+    case RPC_POWMOD:
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+const char *BigNumRpc::opName(int op)
+{
+    static const char *const names[RPC_OP_COUNT] = {
+        "ping", "add", "sub", "mul", "div", "mod", "addmod", "mulmod", "powmod", "inverse"};
+    return op >= 0 && op < RPC_OP_COUNT ? names[op] : "unknown";
+}
+
+const char *BigNumRpc::statusName(int status)
+{
+    switch (status)
+    {
+    case RPC_OK:
+        return "ok";
+    case RPC_BAD_REQUEST:
+        return "bad request";
+    case RPC_DIVISION_BY_ZERO:
+        return "division by zero";
+    case RPC_NO_INVERSE:
+        return "modular inverse does not exist";
+    case RPC_FAILED:
+        return "failed";
+    case RPC_DEADLINE_EXCEEDED:
+        return "deadline exceeded";
+    default:
+        return "unknown status";
+    }
+}
+
+void BigNumRpc::encode(vector<uint8_t> &out, const BigNumRpcFrame &frame)
+{
+    static_assert(sizeof(int) == 4, "operands carry digits as 32-bit ints");
+
+    uint64_t length = HEADER_SIZE;
+    for (const BigNum &value : frame.operands)
+    {
+        length += 8 + 4 * (uint64_t)value.digitCount();
+    }
+    if (length > MAX_FRAME)
+        throw runtime_error("BigNum RPC frame too large");
+
+    out.reserve(out.size() + LENGTH_SIZE + length);
+    put32(out, (uint32_t)length);
+    put32(out, frame.id);
+    put16(out, frame.code);
+    put16(out, (uint16_t)frame.operands.size());
+    for (const BigNum &value : frame.operands)
+    {
+        put32(out, value.is_negative ? 1 : 0);
+        put32(out, (uint32_t)value.digitCount());
+        size_t at = out.size();
+        out.resize(at + 4 * value.digitCount());
+        memcpy(&out[at], value.digitData(), 4 * value.digitCount());
+    }
+}
+
+BigNumRpcFrame BigNumRpc::decode(const uint8_t *body, size_t size)
+{
+    if (size < HEADER_SIZE)
+        throw runtime_error("BigNum RPC frame shorter than its header");
+
+    BigNumRpcFrame frame;
+    uint16_t count;
+    memcpy(&frame.id, body, 4);
+    memcpy(&frame.code, body + 4, 2);
+    memcpy(&count, body + 6, 2);
+
+    size_t offset = HEADER_SIZE;
+    frame.operands.resize(count);
+    for (BigNum &value : frame.operands)
+    {
+        uint32_t flags, length;
+        if (size - offset < 8)
+            throw runtime_error("BigNum RPC operand header truncated");
+        memcpy(&flags, body + offset, 4);
+        memcpy(&length, body + offset + 4, 4);
+        offset += 8;
+        if (length == 0 || length > (size - offset) / 4)
+            throw runtime_error("BigNum RPC operand length out of range");
+
+        // Digits go straight into the operand's storage, then are validated
+        value.digits.resize(length);
+        memcpy(value.digits.data(), body + offset, 4 * (size_t)length);
+        offset += 4 * (size_t)length;
+        for (int digit : value.digits)
+        {
+            if (digit < 0 || digit > 9)
+                throw runtime_error("BigNum RPC operand digit out of range");
+        }
+        if (length > 1 && value.digits.back() == 0)
+            throw runtime_error("BigNum RPC operand has leading zeros");
+        value.is_negative = (flags & 1) && !value.isZero();
+    }
+    if (offset != size)
+        throw runtime_error("BigNum RPC frame has trailing bytes");
+    return frame;
+}
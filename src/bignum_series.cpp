@@ -0,0 +1,220 @@
+#include "bignum_series.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+// Extra working precision of the constants
+static const int GUARD_BITS = 64;
+
+// Right half of a split handed to the pool; whoever claims it runs it
+struct ForkedSplit
+{
+    atomic<bool> claimed;
+    promise<void> done;
+    BigNumSeries::Split result;
+    exception_ptr error;
+
+    ForkedSplit() : claimed(false) {}
+
+    bool claim()
+    {
+        return !claimed.exchange(true);
+    }
+};
+
+// P is only needed by a left half (and by the caller of split), which saves
+// the largest multiplication at every right edge of the tree
+static void splitRange(const BigNumSeries::Term &term, uint64_t begin, uint64_t end, int depth, bool needP,
+                       BigNumSeries::Split &out)
+{
+    if (end - begin == 1)
+    {
+        BigNum a;
+        term(begin, out.p, out.q, a);
+        if (out.q.isZero())
+            throw runtime_error("Series term " + to_string(begin) + " has q = 0");
+        out.t = a * out.p;
+        return;
+    }
+
+    const uint64_t mid = begin + (end - begin) / 2;
+    BigNumSeries::Split left, right;
+    if (depth > 0)
+    {
+        // The task holds only the shared state and never touches term
+        // unless it wins the claim, so the parent may return once it has
+        // run the half itself
+        shared_ptr<ForkedSplit> job = make_shared<ForkedSplit>();
+        BigNumThreadPool::shared().submit([job, &term, mid, end, depth, needP]
+                                          {
+                                              if (!job->claim())
+                                                  return;
+                                              try
+                                              {
+                                                  splitRange(term, mid, end, depth - 1, needP, job->result);
+                                              }
+                                              catch (...)
+                                              {
+                                                  job->error = current_exception();
+                                              }
+                                              job->done.set_value();
+                                          });
+
+        exception_ptr leftError;
+        try
+        {
+            splitRange(term, begin, mid, depth - 1, true, left);
+        }
+        catch (...)
+        {
+            leftError = current_exception();
+        }
+        if (job->claim())
+        {
+            if (leftError)
+                rethrow_exception(leftError);
+            splitRange(term, mid, end, depth - 1, needP, right);
+        }
+        else
+        {
+            job->done.get_future().wait();
+            if (leftError)
+                rethrow_exception(leftError);
+            if (job->error)
+                rethrow_exception(job->error);
+            right = std::move(job->result);
+        }
+    }
+    else
+    {
+        splitRange(term, begin, mid, 0, true, left);
+        splitRange(term, mid, end, 0, needP, right);
+    }
+
+    out.t = left.t * right.q + left.p * right.t;
+    out.q = left.q * right.q;
+    if (needP)
+        out.p = left.p * right.p;
+    else
+        out.p = BigNum(0);
+}
+
+// T / Q over [0, terms) at the working precision
+static BigFloat sumAt(const BigNumSeries::Term &term, uint64_t terms, int precision, int depth)
+{
+    BigNumSeries::Split s;
+    splitRange(term, 0, terms, depth, false, s);
+    return BigFloat::div(BigFloat(s.t, precision), BigFloat(s.q, precision), precision);
+}
+
+// Terms of a series whose term ratio is at most 10^-digitsPerTerm
+static uint64_t termsFor(int precision, double digitsPerTerm)
+{
+    return (uint64_t)((double)BigFloat::digitsForPrecision(precision) / digitsPerTerm) + 2;
+}
+
+static BigFloat roundTo(const BigFloat &x, int precision)
+{
+    return BigFloat(x.mantissa(), x.exponent(), precision);
+}
+
+BigNumSeries::Split BigNumSeries::split(const Term &term, uint64_t begin, uint64_t end, int depth)
+{
+    if (begin >= end)
+        throw runtime_error("Empty series range");
+    Split s;
+    splitRange(term, begin, end, depth < 0 ? BigNum::parallelDepth() : depth, true, s);
+    return s;
+}
+
+BigFloat BigNumSeries::sum(const Term &term, uint64_t terms, int precision)
+{
+    if (terms == 0)
+        return BigFloat(BigNum(0), precision);
+    return roundTo(sumAt(term, terms, precision + GUARD_BITS, BigNum::parallelDepth()), precision);
+}
+
+BigFloat BigNumSeries::pi(int precision)
+{
+    const int w = precision + GUARD_BITS;
+    // log10(640320^3 / 24 / (6 * 2 * 6)) digits per term
+    const uint64_t terms = termsFor(w, 14.18);
+    Term term = [](uint64_t n, BigNum &p, BigNum &q, BigNum &a)
+    {
+        if (n == 0)
+        {
+            p = BigNum(1);
+            q = BigNum(1);
+        }
+        else
+        {
+            long long k = (long long)n;
+            p = -(BigNum(6 * k - 5) * BigNum(2 * k - 1) * BigNum(6 * k - 1));
+            q = BigNum(k) * BigNum(k) * BigNum(k) * BigNum(10939058860032000LL); // 640320^3 / 24
+        }
+        a = BigNum(13591409) + BigNum(545140134) * BigNum((long long)n);
+    };
+
+    Split s;
+    splitRange(term, 0, terms, BigNum::parallelDepth(), false, s);
+    // pi = 426880 sqrt(10005) Q / T
+    BigFloat root = BigFloat::sqrt(BigFloat(BigNum(10005), w), w);
+    BigFloat numerator = BigFloat::mul(BigFloat::mul(BigFloat(BigNum(426880), w), root, w), BigFloat(s.q, w), w);
+    return roundTo(BigFloat::div(numerator, BigFloat(s.t, w), w), precision);
+}
+
+BigFloat BigNumSeries::e(int precision)
+{
+    const int w = precision + GUARD_BITS;
+    const double digits = (double)BigFloat::digitsForPrecision(w);
+    uint64_t terms = 1;
+    for (double magnitude = 0; magnitude <= digits + 1; terms++)
+        magnitude += log10((double)terms); // log10(terms!)
+
+    Term term = [](uint64_t n, BigNum &p, BigNum &q, BigNum &a)
+    {
+        p = BigNum(1);
+        q = BigNum(n == 0 ? 1 : (long long)n);
+        a = BigNum(1);
+    };
+    return roundTo(sumAt(term, terms, w, BigNum::parallelDepth()), precision);
+}
+
+BigFloat BigNumSeries::log2(int precision)
+{
+    const int w = precision + GUARD_BITS;
+    Term term = [](uint64_t n, BigNum &p, BigNum &q, BigNum &a)
+    {
+        // ratio -n / (4 (2n + 1)) between consecutive terms
+        p = n == 0 ? BigNum(1) : BigNum(-(long long)n);
+        q = n == 0 ? BigNum(1) : BigNum(8 * (long long)n + 4);
+        a = BigNum(1);
+    };
+    BigFloat s = sumAt(term, termsFor(w, log10(8.0)), w, BigNum::parallelDepth());
+    return roundTo(BigFloat::mul(s, BigFloat(BigNum(75), -2, w), w), precision);
+}
+
+BigFloat BigNumSeries::arctanInverse(uint32_t x, int precision)
+{
+    if (x == 0)
+        throw runtime_error("arctanInverse of zero");
+
+    const int w = precision + GUARD_BITS;
+    const BigNum x2 = BigNum((long long)x) * BigNum((long long)x) + BigNum(1);
+    Term term = [x, &x2](uint64_t n, BigNum &p, BigNum &q, BigNum &a)
+    {
+        // ratio 2n / ((2n + 1) (x^2 + 1)) between consecutive terms
+        p = n == 0 ? BigNum((long long)x) : BigNum(2 * (long long)n);
+        q = n == 0 ? x2 : BigNum(2 * (long long)n + 1) * x2;
+        a = BigNum(1);
+    };
+    const double digitsPerTerm = log10((double)x * x + 1);
+    return roundTo(sumAt(term, termsFor(w, digitsPerTerm), w, BigNum::parallelDepth()), precision);
+}
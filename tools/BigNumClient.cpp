@@ -0,0 +1,414 @@
+#include "bignum.hpp"
+#include "bignum_rpc.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ * BigNumClient - client and load generator for BigNumCalculator --serve
+ *
+ * One-shot:  BigNumClient --socket PATH OP OPERAND...
+ *            e.g. BigNumClient --socket /tmp/bn.sock mulmod 3 4 5
+ *
+ * Load:      BigNumClient --socket PATH [--op OP] [--requests N]
+ *                         [--connections C] [--depth D] [--digits K]
+ *                         [--moduli M] [--seed S] [--verify]
+ *
+ * The load generator opens C connections, each keeping up to D requests
+ * in flight, with operands of K digits drawn against a pool of M moduli
+ * (so the server's context cache sees a realistic hit rate). It reports
+ * throughput and latency percentiles. With --verify every result is
+ * recomputed locally and any mismatch or error fails the run. --wait
+ * SECONDS retries the connection while the server starts up.
+ */
+
+static const size_t MAX_DEPTH = 1024; // the server's per-connection in-flight window
+
+struct LoadOptions
+{
+    int op = RPC_MULMOD;
+    unsigned long long requests = 10000;
+    unsigned connections = 1;
+    size_t depth = 64;
+    size_t digits = 100;
+    size_t moduli = 4;
+    unsigned long long seed = 1;
+    bool verify = false;
+};
+
+struct LoadResult
+{
+    vector<double> latencies; // microseconds
+    unsigned long long failures = 0;
+    string firstFailure;
+};
+
+static int connectTo(const string &path, double waitSeconds)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof address.sun_path)
+        throw runtime_error("socket path too long: " + path);
+    memcpy(address.sun_path, path.c_str(), path.size());
+
+    auto deadline = chrono::steady_clock::now() + chrono::duration<double>(waitSeconds);
+    while (true)
+    {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            throw runtime_error(string("socket: ") + strerror(errno));
+        if (connect(fd, (sockaddr *)&address, sizeof address) == 0)
+            return fd;
+        int error = errno;
+        close(fd);
+        if (chrono::steady_clock::now() >= deadline)
+            throw runtime_error("cannot connect to " + path + ": " + strerror(error));
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+}
+
+static void sendAll(int fd, const vector<uint8_t> &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t n = write(fd, data.data() + sent, data.size() - sent);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw runtime_error("connection closed while sending");
+        sent += n;
+    }
+}
+
+static void receiveAll(int fd, void *buffer, size_t size)
+{
+    char *p = static_cast<char *>(buffer);
+    while (size > 0)
+    {
+        ssize_t n = read(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw runtime_error("connection closed while receiving");
+        p += n;
+        size -= n;
+    }
+}
+
+static BigNumRpcFrame receiveFrame(int fd)
+{
+    uint32_t length;
+    receiveAll(fd, &length, sizeof length);
+    if (length < BigNumRpc::HEADER_SIZE || length > BigNumRpc::MAX_FRAME)
+        throw runtime_error("server sent a malformed frame");
+    vector<uint8_t> body(length);
+    receiveAll(fd, body.data(), length);
+    return BigNumRpc::decode(body.data(), body.size());
+}
+
+static int parseOp(const string &name)
+{
+    for (int op = 0; op < RPC_OP_COUNT; op++)
+    {
+        if (name == BigNumRpc::opName(op))
+            return op;
+    }
+    throw runtime_error("unknown operation '" + name + "'");
+}
+
+// The local answer the server should give, in the same status/result form
+static BigNumRpcFrame expected(int op, const vector<BigNum> &x)
+{
+    BigNumRpcFrame frame;
+    frame.code = RPC_OK;
+    try
+    {
+        switch (op)
+        {
+        case RPC_ADD:
+            frame.operands.push_back(x[0] + x[1]);
+            break;
+        case RPC_SUB:
+            frame.operands.push_back(x[0] - x[1]);
+            break;
+        case RPC_MUL:
+            frame.operands.push_back(x[0] * x[1]);
+            break;
+        case RPC_DIV:
+            frame.operands.push_back(x[0] / x[1]);
+            break;
+        case RPC_MOD:
+            frame.operands.push_back(x[0] % x[1]);
+            break;
+        case RPC_ADDMOD:
+            frame.operands.push_back(x[0].addMod(x[1], x[2]));
+            break;
+        case RPC_MULMOD:
+            frame.operands.push_back(x[0].mulMod(x[1], x[2]));
+            break;
+        case RPC_POWMOD:
+            frame.operands.push_back(x[0].powMod(x[1], x[2]));
+            break;
+        case RPC_INVERSE:
+            frame.operands.push_back(x[0].modInverse(x[1]));
+            break;
+        }
+    }
+    catch (const exception &)
+    {
+        frame.code = x.back().isZero() ? RPC_DIVISION_BY_ZERO : RPC_NO_INVERSE;
+    }
+    return frame;
+}
+
+static BigNum randomNumber(mt19937_64 &rng, size_t digits)
+{
+    string text(digits, '0');
+    text[0] = '1' + rng() % 9;
+    for (size_t i = 1; i < digits; i++)
+    {
+        text[i] = '0' + rng() % 10;
+    }
+    return BigNum(text);
+}
+
+static void runConnection(const string &path, const LoadOptions &options, unsigned long long quota,
+                          unsigned long long seed, const vector<BigNum> &moduli, LoadResult &result)
+{
+    typedef chrono::steady_clock Clock;
+    struct Pending
+    {
+        Clock::time_point start;
+        vector<BigNum> operands;
+    };
+
+    mt19937_64 rng(seed);
+    int fd = -1;
+    map<uint32_t, Pending> pending;
+    vector<uint8_t> out;
+    uint32_t nextId = 0;
+    unsigned long long sent = 0;
+    int arity = BigNumRpc::arity(options.op);
+
+    try
+    {
+        fd = connectTo(path, 0);
+        while (sent < quota || !pending.empty())
+        {
+            // Top up the window with one write, then wait for one answer
+            out.clear();
+            while (sent < quota && pending.size() < options.depth)
+            {
+                BigNumRpcFrame request;
+                request.id = nextId++;
+                request.code = (uint16_t)options.op;
+                for (int i = 0; i < arity; i++)
+                {
+                    bool modulus = i == arity - 1 && options.op >= RPC_DIV;
+                    request.operands.push_back(modulus ? moduli[rng() % moduli.size()] : randomNumber(rng, options.digits));
+                }
+                BigNumRpc::encode(out, request);
+                Pending &entry = pending[request.id];
+                entry.start = Clock::now();
+                if (options.verify)
+                    entry.operands = std::move(request.operands);
+                sent++;
+            }
+            if (!out.empty())
+                sendAll(fd, out);
+
+            BigNumRpcFrame response = receiveFrame(fd);
+            auto it = pending.find(response.id);
+            if (it == pending.end())
+                throw runtime_error("response to unknown request " + to_string(response.id));
+            result.latencies.push_back(chrono::duration<double, micro>(Clock::now() - it->second.start).count());
+
+            bool failed = response.code == RPC_BAD_REQUEST || response.code == RPC_FAILED;
+            if (options.verify && !failed)
+            {
+                BigNumRpcFrame want = expected(options.op, it->second.operands);
+                failed = want.code != response.code || want.operands.size() != response.operands.size() ||
+                         (!want.operands.empty() && want.operands[0] != response.operands[0]);
+            }
+            if (failed && result.failures++ == 0)
+                result.firstFailure = "request " + to_string(response.id) + ": " + BigNumRpc::statusName(response.code);
+            pending.erase(it);
+        }
+    }
+    catch (const exception &e)
+    {
+        result.failures += pending.size() + (quota - sent) + 1;
+        if (result.firstFailure.empty())
+            result.firstFailure = e.what();
+    }
+    if (fd >= 0)
+        close(fd);
+}
+
+static int runLoad(const string &path, const LoadOptions &options)
+{
+    mt19937_64 rng(options.seed);
+    vector<BigNum> moduli;
+    for (size_t i = 0; i < max<size_t>(1, options.moduli); i++)
+    {
+        // Odd moduli keep inverse requests mostly answerable
+        BigNum m = randomNumber(rng, options.digits);
+        moduli.push_back(m.isZero() ? BigNum(1) : m * BigNum(2) + BigNum(1));
+    }
+
+    vector<LoadResult> results(options.connections);
+    vector<thread> threads;
+    auto start = chrono::steady_clock::now();
+    for (unsigned c = 0; c < options.connections; c++)
+    {
+        unsigned long long quota = options.requests / options.connections + (c < options.requests % options.connections);
+        threads.emplace_back(runConnection, cref(path), cref(options), quota, options.seed * 1000003 + c, cref(moduli),
+                             ref(results[c]));
+    }
+    for (thread &t : threads)
+    {
+        t.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<double> latencies;
+    unsigned long long failures = 0;
+    string firstFailure;
+    for (const LoadResult &r : results)
+    {
+        latencies.insert(latencies.end(), r.latencies.begin(), r.latencies.end());
+        failures += r.failures;
+        if (firstFailure.empty())
+            firstFailure = r.firstFailure;
+    }
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p)
+    {
+        return latencies.empty() ? 0.0 : latencies[min(latencies.size() - 1, (size_t)(p * latencies.size()))];
+    };
+
+    char line[200];
+    snprintf(line, sizeof line, "%s: %zu responses in %.3f s (%.1f req/s), %u connections x depth %zu, %zu digits\n",
+             BigNumRpc::opName(options.op), latencies.size(), seconds, latencies.size() / seconds, options.connections,
+             options.depth, options.digits);
+    cout << line;
+    snprintf(line, sizeof line, "latency us: p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n", percentile(0.5),
+             percentile(0.9), percentile(0.99), latencies.empty() ? 0.0 : latencies.back());
+    cout << line;
+    if (failures)
+    {
+        cout << failures << " failed (" << firstFailure << ")" << endl;
+        return 1;
+    }
+    cout << (options.verify ? "all results verified" : "no errors") << endl;
+    return 0;
+}
+
+static int runOnce(const string &path, double waitSeconds, const vector<string> &words)
+{
+    BigNumRpcFrame request;
+    request.id = 1;
+    request.code = (uint16_t)parseOp(words[0]);
+    for (size_t i = 1; i < words.size(); i++)
+    {
+        request.operands.push_back(BigNum(words[i]));
+    }
+
+    int fd = connectTo(path, waitSeconds);
+    vector<uint8_t> out;
+    BigNumRpc::encode(out, request);
+    sendAll(fd, out);
+    BigNumRpcFrame response = receiveFrame(fd);
+    close(fd);
+
+    if (response.code != RPC_OK)
+    {
+        cout << "Error: " << BigNumRpc::statusName(response.code) << endl;
+        return 1;
+    }
+    cout << (response.operands.empty() ? "ok" : response.operands[0].toString()) << endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    string path;
+    double waitSeconds = 0;
+    LoadOptions options;
+    string opName = BigNumRpc::opName(options.op);
+    vector<string> words;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue)
+            path = argv[++i];
+        else if (arg == "--wait" && hasValue)
+            waitSeconds = atof(argv[++i]);
+        else if (arg == "--op" && hasValue)
+            opName = argv[++i];
+        else if (arg == "--requests" && hasValue)
+            options.requests = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--connections" && hasValue)
+            options.connections = max(1ul, strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--depth" && hasValue)
+            options.depth = min(MAX_DEPTH, max<size_t>(1, strtoul(argv[++i], nullptr, 10)));
+        else if (arg == "--digits" && hasValue)
+            options.digits = max<size_t>(1, strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--moduli" && hasValue)
+            options.moduli = strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--seed" && hasValue)
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--verify")
+            options.verify = true;
+        else if (arg.compare(0, 2, "--") != 0)
+            words.push_back(arg);
+        else
+        {
+            path.clear();
+            break;
+        }
+    }
+
+    if (path.empty())
+    {
+        cerr << "Usage: " << argv[0] << " --socket PATH [--wait SECONDS] OP OPERAND..." << endl
+             << "       " << argv[0] << " --socket PATH [--wait SECONDS] [--op OP] [--requests N]" << endl
+             << "              [--connections C] [--depth D] [--digits K] [--moduli M] [--seed S] [--verify]"
+             << endl;
+        return 2;
+    }
+
+    try
+    {
+        if (!words.empty())
+            return runOnce(path, waitSeconds, words);
+        options.op = parseOp(opName);
+        close(connectTo(path, waitSeconds)); // wait for the server once, not per connection
+        return runLoad(path, options);
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,190 @@
+#include "bignum.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * BigNumTune - finds BigNum's algorithm crossover points on this machine
+ *
+ * For each operand size in a geometric sweep, times schoolbook
+ * multiplication against one Karatsuba level over schoolbook halves. The
+ * threshold is the smallest size from which Karatsuba keeps winning for
+ * the rest of a short confirmation window, which filters out timer noise.
+ *
+ * Usage: BigNumTune [--config FILE] [--header FILE]
+ *                   [--min-time SECONDS] [--max-digits N]
+ *
+ * --config writes a runtime file for the BIGNUM_TUNING environment
+ * variable; --header writes a header for -DBIGNUM_TUNING_HEADER. With
+ * neither, the config lines are printed to stdout.
+ */
+
+static const int CONFIRM = 3; // consecutive winning sizes required
+
+static BigNum randomDigits(mt19937_64 &rng, size_t digits)
+{
+    string text(digits, '0');
+    text[0] = '1' + rng() % 9;
+    for (size_t i = 1; i < digits; i++)
+    {
+        text[i] = '0' + rng() % 10;
+    }
+    return BigNum(text);
+}
+
+// Best-of-three ns per multiplication with the given Karatsuba threshold
+static double timeMultiply(const BigNum &a, const BigNum &b, size_t threshold, double minTime)
+{
+    typedef chrono::steady_clock Clock;
+    BigNumTuning tuning = BigNum::tuning();
+    tuning.karatsubaThreshold = threshold;
+    BigNum::setTuning(tuning);
+
+    double best = 0;
+    for (int round = 0; round < 3; round++)
+    {
+        unsigned long long iterations = 0;
+        Clock::time_point start = Clock::now();
+        double elapsed = 0;
+        do
+        {
+            BigNum product = a * b;
+            iterations++;
+            elapsed = chrono::duration<double>(Clock::now() - start).count();
+        } while (elapsed < minTime);
+
+        double ns = elapsed * 1e9 / iterations;
+        if (round == 0 || ns < best)
+            best = ns;
+    }
+    return best;
+}
+
+static string cpuModel()
+{
+    ifstream in("/proc/cpuinfo");
+    string line;
+    while (getline(in, line))
+    {
+        if (line.compare(0, 10, "model name") == 0)
+        {
+            size_t colon = line.find(':');
+            return colon == string::npos ? string() : line.substr(line.find_first_not_of(" \t", colon + 1));
+        }
+    }
+    return "unknown CPU";
+}
+
+static void writeHeader(const string &path, const BigNumTuning &tuning)
+{
+    ofstream out(path.c_str());
+    if (!out)
+        throw runtime_error("Cannot write " + path);
+
+    char date[64];
+    time_t now = time(nullptr);
+    strftime(date, sizeof date, "%Y-%m-%d", localtime(&now));
+
+    out << "// Generated by BigNumTune on " << date << " for " << cpuModel() << "; do not edit.\n";
+    out << "#ifndef BIGNUM_TUNING_H\n#define BIGNUM_TUNING_H\n\n";
+    out << "#define BIGNUM_KARATSUBA_THRESHOLD " << tuning.karatsubaThreshold << "\n";
+    out << "\n#endif // BIGNUM_TUNING_H\n";
+}
+
+int main(int argc, char *argv[])
+{
+    string configPath, headerPath;
+    double minTime = 0.02;
+    size_t maxDigits = 1024;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc)
+            configPath = argv[++i];
+        else if (arg == "--header" && i + 1 < argc)
+            headerPath = argv[++i];
+        else if (arg == "--min-time" && i + 1 < argc)
+            minTime = atof(argv[++i]);
+        else if (arg == "--max-digits" && i + 1 < argc)
+            maxDigits = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            cerr << "Usage: " << argv[0]
+                 << " [--config FILE] [--header FILE] [--min-time SECONDS] [--max-digits N]" << endl;
+            return 2;
+        }
+    }
+
+    const size_t NEVER = (size_t)-1;
+    BigNumTuning tuning = BigNum::tuning();
+    mt19937_64 rng(2025);
+
+    cout << "Karatsuba crossover (" << cpuModel() << ")" << endl;
+    printf("%10s %16s %16s %8s\n", "digits", "schoolbook ns", "karatsuba ns", "ratio");
+
+    size_t candidate = 0;
+    int wins = 0;
+    for (size_t digits = 8; digits <= maxDigits; digits = digits * 5 / 4 + 1)
+    {
+        BigNum a = randomDigits(rng, digits);
+        BigNum b = randomDigits(rng, digits);
+        double schoolbook = timeMultiply(a, b, NEVER, minTime);
+        double karatsuba = timeMultiply(a, b, digits, minTime);
+        printf("%10zu %16.0f %16.0f %8.2f\n", digits, schoolbook, karatsuba, schoolbook / karatsuba);
+
+        if (karatsuba < schoolbook)
+        {
+            if (wins++ == 0)
+                candidate = digits;
+            if (wins == CONFIRM)
+                break;
+        }
+        else
+        {
+            wins = 0;
+        }
+    }
+
+    if (wins == 0)
+    {
+        cout << "No crossover up to " << maxDigits << " digits; Karatsuba disabled below it" << endl;
+        candidate = maxDigits + 1;
+    }
+    tuning.karatsubaThreshold = candidate;
+
+    try
+    {
+        if (!configPath.empty())
+        {
+            tuning.save(configPath);
+            cout << "Wrote " << configPath << " (use with BIGNUM_TUNING=" << configPath << ")" << endl;
+        }
+        if (!headerPath.empty())
+        {
+            writeHeader(headerPath, tuning);
+            cout << "Wrote " << headerPath << " (use with -DBIGNUM_TUNING_HEADER='\"" << headerPath << "\"')"
+                 << endl;
+        }
+        if (configPath.empty() && headerPath.empty())
+        {
+            cout << "karatsuba_threshold = " << tuning.karatsubaThreshold << endl;
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}